@@ -0,0 +1,44 @@
+#include "cancellation.hpp"
+#include "semantic_error.hpp"
+
+// the token evaluation on this thread checks, if any
+static thread_local const CancellationToken * currentToken = nullptr;
+
+const char * const CancellationToken::INTERRUPTED = "Error: interpreter kernel interrupted";
+
+CancellationToken::CancellationToken() noexcept: m_cancelled(false){}
+
+// cancel and reset are sequentially consistent so an Interpreter can order
+// them against the cut-off it records for queued requests
+void CancellationToken::cancel() noexcept{
+  m_cancelled.store(true);
+}
+
+void CancellationToken::reset() noexcept{
+  m_cancelled.store(false);
+}
+
+bool CancellationToken::isCancelled() const noexcept{
+  return m_cancelled.load(std::memory_order_relaxed);
+}
+
+const CancellationToken * CancellationToken::current() noexcept{
+  return currentToken;
+}
+
+void CancellationToken::check(){
+
+  if(currentToken && currentToken->isCancelled()){
+    throw SemanticError(INTERRUPTED);
+  }
+}
+
+CancellationScope::CancellationScope(const CancellationToken * token) noexcept
+  : m_previous(currentToken)
+{
+  currentToken = token;
+}
+
+CancellationScope::~CancellationScope(){
+  currentToken = m_previous;
+}
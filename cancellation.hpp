@@ -0,0 +1,74 @@
+/*! \file cancellation.hpp
+Defines the token used to interrupt a running evaluation.
+ */
+#ifndef CANCELLATION_HPP
+#define CANCELLATION_HPP
+
+#include <atomic>
+
+/*! \class CancellationToken
+\brief A flag that another thread, or a signal handler, sets to ask the
+evaluation watching it to stop.
+
+Evaluation does not take the token as an argument. An Interpreter installs
+its token as the current one for its thread while it evaluates, with a
+CancellationScope, and Expression::eval, lambda calls and the long-running
+built-ins call CancellationToken::check() as they go. Work handed to the
+thread pool installs the token of the thread that handed it over.
+ */
+class CancellationToken {
+public:
+
+  /// Construct a token that is not cancelled
+  CancellationToken() noexcept;
+
+  CancellationToken(const CancellationToken &) = delete;
+  CancellationToken & operator=(const CancellationToken &) = delete;
+
+  /// ask the evaluation to stop; safe to call from a signal handler
+  void cancel() noexcept;
+
+  /// clear the request, before a new evaluation starts
+  void reset() noexcept;
+
+  /// true once cancel has been called, until reset
+  bool isCancelled() const noexcept;
+
+  /// the token installed for this thread, nullptr if none
+  static const CancellationToken * current() noexcept;
+
+  /*! Stop the evaluation on this thread if its token is cancelled.
+    \throws SemanticError INTERRUPTED
+   */
+  static void check();
+
+  /// the error an interrupted evaluation reports
+  static const char * const INTERRUPTED;
+
+private:
+
+  std::atomic<bool> m_cancelled;
+};
+
+/*! \class CancellationScope
+\brief Installs a token as the current one for this thread for the lifetime
+of the scope, restoring the previous one after.
+ */
+class CancellationScope {
+public:
+
+  /// install token (which may be nullptr) for this thread
+  explicit CancellationScope(const CancellationToken * token) noexcept;
+
+  /// restore the token installed before
+  ~CancellationScope();
+
+  CancellationScope(const CancellationScope &) = delete;
+  CancellationScope & operator=(const CancellationScope &) = delete;
+
+private:
+
+  const CancellationToken * m_previous;
+};
+
+#endif
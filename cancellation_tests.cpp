@@ -0,0 +1,69 @@
+#include "catch.hpp"
+
+#include "cancellation.hpp"
+#include "semantic_error.hpp"
+
+#include <thread>
+
+TEST_CASE( "Test cancellation token", "[cancellation]" )
+{
+  CancellationToken token;
+  REQUIRE(!token.isCancelled());
+
+  token.cancel();
+  REQUIRE(token.isCancelled());
+  token.cancel();
+  REQUIRE(token.isCancelled());
+
+  token.reset();
+  REQUIRE(!token.isCancelled());
+}
+
+TEST_CASE( "Test cancellation scope", "[cancellation]" )
+{
+  REQUIRE(CancellationToken::current() == nullptr);
+  REQUIRE_NOTHROW(CancellationToken::check());
+
+  CancellationToken outer;
+  CancellationToken inner;
+  {
+    CancellationScope outerScope(&outer);
+    REQUIRE(CancellationToken::current() == &outer);
+
+    {
+      CancellationScope innerScope(&inner);
+      REQUIRE(CancellationToken::current() == &inner);
+
+      outer.cancel();
+      REQUIRE_NOTHROW(CancellationToken::check());
+      inner.cancel();
+      REQUIRE_THROWS_AS(CancellationToken::check(), SemanticError);
+    }
+
+    REQUIRE(CancellationToken::current() == &outer);
+    REQUIRE_THROWS_AS(CancellationToken::check(), SemanticError);
+
+    {
+      INFO("a scope without a token stops checks");
+      CancellationScope none(nullptr);
+      REQUIRE_NOTHROW(CancellationToken::check());
+    }
+  }
+
+  REQUIRE(CancellationToken::current() == nullptr);
+  REQUIRE_NOTHROW(CancellationToken::check());
+}
+
+TEST_CASE( "Test cancellation scope is per thread", "[cancellation]" )
+{
+  CancellationToken token;
+  token.cancel();
+  CancellationScope scope(&token);
+
+  const CancellationToken * seen = &token;
+  std::thread other([&seen](){ seen = CancellationToken::current(); });
+  other.join();
+
+  REQUIRE(seen == nullptr);
+  REQUIRE_THROWS_AS(CancellationToken::check(), SemanticError);
+}
@@ -1,6 +1,11 @@
 #include "environment.hpp"
 #include "semantic_error.hpp"
+#include "vector_ops.hpp"
+#include "matrix.hpp"
+#include "cancellation.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <complex>
@@ -15,6 +20,148 @@ bool nargs_equal(const std::vector<Expression> & args, unsigned nargs){
   return args.size() == nargs;
 }
 
+// predicate, any argument is a List (the call is element-wise)
+bool any_list(const std::vector<Expression> & args){
+  for(auto & a : args){
+    if(a.isHeadList()) return true;
+  }
+  return false;
+}
+
+// predicate, any argument is a Matrix (the call is element-wise over it)
+bool any_matrix(const std::vector<Expression> & args){
+  for(auto & a : args){
+    if(a.isHeadMatrix()) return true;
+  }
+  return false;
+}
+
+/*
+ * Element-wise form of an arithmetic procedure over Matrices. Every argument
+ * is a Matrix of one shape, or a Number broadcast over every entry. The first
+ * argument seeds the result and op folds in each of the others.
+ */
+Expression matrixwise(const std::vector<Expression> & args, MatrixOp op,
+                      const std::string & name)
+{
+  const Matrix * shape = nullptr;
+  for(auto & a : args){
+    if(a.isHeadMatrix()){
+      if(shape && ((a.asMatrix()->rows() != shape->rows()) || (a.asMatrix()->cols() != shape->cols()))){
+        throw SemanticError("Error in call to " + name + ": matrices of different shape");
+      }
+      shape = a.asMatrix();
+    }
+    else if(!a.isHeadNumber()){
+      throw SemanticError("Error in call to " + name + ", argument not a number");
+    }
+  }
+
+  Matrix result = args[0].isHeadMatrix() ? *args[0].asMatrix()
+                  : Matrix(shape->rows(), shape->cols(), args[0].head().asNumber());
+
+  for(std::size_t i = 1; i < args.size(); i++){
+    if(args[i].isHeadMatrix()){
+      matrixElementwise(result, *args[i].asMatrix(), op);
+    }
+    else{
+      matrixElementwise(result, args[i].head().asNumber(), op);
+    }
+  }
+
+  return Expression::makeMatrix(std::move(result));
+}
+
+/*
+ * Pack the arguments of an element-wise call. Number and Complex arguments
+ * are broadcast over every element, and all List arguments must have the
+ * same length, which is returned.
+ */
+std::size_t pack_args(const std::vector<Expression> & args,
+                      std::vector<PackedArray> & packed,
+                      const std::string & name)
+{
+  packed.resize(args.size());
+  std::size_t n = 0;
+  bool sized = false;
+
+  for(std::size_t i = 0; i < args.size(); i++){
+    if(!pack(args[i], packed[i])){
+      throw SemanticError("Error in call to " + name + ", argument not a number");
+    }
+    if(!packed[i].broadcast){
+      if(sized && (packed[i].size() != n)){
+        throw SemanticError("Error in call to " + name + ": lists of different length");
+      }
+      n = packed[i].size();
+      sized = true;
+    }
+  }
+
+  return n;
+}
+
+/*
+ * Element-wise form of an arithmetic procedure. The first argument seeds the
+ * result and op folds in each of the others. Elements follow the scalar
+ * promotion rule: an element of the result is Complex if any of the values
+ * it was computed from is.
+ */
+Expression elementwise(const std::vector<Expression> & args,
+                       void (*op)(PackedArray &, const PackedArray &),
+                       const std::string & name)
+{
+  std::vector<PackedArray> packed;
+  std::size_t n = pack_args(args, packed, name);
+
+  PackedArray result = packed[0];
+  result.expand(n);
+
+  for(std::size_t i = 1; i < packed.size(); i++){
+    CancellationToken::check();
+    op(result, packed[i]);
+  }
+
+  return unpack(result);
+}
+
+// element-wise form of a binary procedure whose op can reject its domain
+Expression elementwise(const std::vector<Expression> & args,
+                       bool (*op)(PackedArray &, const PackedArray &),
+                       const std::string & name)
+{
+  std::vector<PackedArray> packed;
+  std::size_t n = pack_args(args, packed, name);
+
+  PackedArray result = packed[0];
+  result.expand(n);
+
+  if(!op(result, packed[1])){
+    throw SemanticError("Error in call to " + name + ": invalid argument.");
+  }
+
+  return unpack(result);
+}
+
+// element-wise form of a unary procedure over a List argument
+Expression elementwise(const Expression & arg,
+                       bool (*op)(PackedArray &),
+                       const std::string & name)
+{
+  PackedArray values;
+  if(!pack(arg, values) || !op(values)){
+    throw SemanticError("Error in call to " + name + ": invalid argument.");
+  }
+
+  return unpack(values);
+}
+
+// issue a process-wide unique version stamp (0 is never issued)
+unsigned long next_version(){
+  static std::atomic<unsigned long> counter(0);
+  return ++counter;
+}
+
 
 /*********************************************************************** 
 Each of the functions below have the signature that corresponds to the
@@ -29,6 +176,16 @@ Expression default_proc(const std::vector<Expression> & args){
 
 Expression add(const std::vector<Expression> & args)
 {
+  // Matrices are added element-wise
+  if(any_matrix(args)){
+    return matrixwise(args, MatrixOp::Add, "add");
+  }
+
+  // Lists are added element-wise
+  if(any_list(args)){
+    return elementwise(args, packedAdd, "add");
+  }
+
   // If any argument is complex, the result should be complex
   double realSum = 0.0;
   double imagSum = 0.0;
@@ -58,6 +215,16 @@ Expression add(const std::vector<Expression> & args)
 
 Expression mul(const std::vector<Expression> & args)
 {
+  // Matrices are multiplied element-wise, matmul is their matrix product
+  if(any_matrix(args)){
+    return matrixwise(args, MatrixOp::Mul, "multiply");
+  }
+
+  // Lists are multiplied element-wise
+  if(any_list(args)){
+    return elementwise(args, packedMul, "multiply");
+  }
+
   // If any argument is complex, the result should be complex
   std::complex<double> result = (1.0);
   bool has_complex = false; // Flag to determine result type
@@ -90,6 +257,27 @@ Expression subneg(const std::vector<Expression> & args)
   double imagResult = 0.0;
   bool has_complex = false;
 
+  // Matrices are negated or subtracted element-wise
+  if(any_matrix(args) && nargs_equal(args,1)){
+    return matrixwise({Expression(0.0), args[0]}, MatrixOp::Sub, "negate");
+  }
+  if(any_matrix(args) && nargs_equal(args,2)){
+    return matrixwise(args, MatrixOp::Sub, "subtraction");
+  }
+
+  // Lists are negated or subtracted element-wise
+  if(any_list(args) && nargs_equal(args,1)){
+    PackedArray values;
+    if(!pack(args[0], values)){
+      throw SemanticError("Error in call to negate: invalid argument.");
+    }
+    packedNeg(values);
+    return unpack(values);
+  }
+  if(any_list(args) && nargs_equal(args,2)){
+    return elementwise(args, packedSub, "subtraction");
+  }
+
   // preconditions
   if(nargs_equal(args,1)){
     if(args[0].isHeadNumber()){
@@ -135,6 +323,27 @@ Expression div(const std::vector<Expression> & args)
   std::complex<double> result = (1.0);
   bool has_complex = false;
 
+  // Matrices are inverted or divided element-wise
+  if(any_matrix(args) && nargs_equal(args,1)){
+    return matrixwise({Expression(1.0), args[0]}, MatrixOp::Div, "division");
+  }
+  if(any_matrix(args) && nargs_equal(args,2)){
+    return matrixwise(args, MatrixOp::Div, "division");
+  }
+
+  // Lists are inverted or divided element-wise
+  if(any_list(args) && nargs_equal(args,1)){
+    PackedArray values;
+    if(!pack(args[0], values)){
+      throw SemanticError("Error in call to division: invalid argument.");
+    }
+    packedRecip(values);
+    return unpack(values);
+  }
+  if(any_list(args) && nargs_equal(args,2)){
+    return elementwise(args, packedDiv, "division");
+  }
+
   if(nargs_equal(args,1)){
     if(args[0].isHeadNumber()){
       result = 1/args[0].head().asNumber();
@@ -173,6 +382,11 @@ Expression div(const std::vector<Expression> & args)
 
 Expression sqrt(const std::vector<Expression> & args)
 {
+	// Lists are rooted element-wise
+	if (nargs_equal(args, 1) && args[0].isHeadList()) {
+		return elementwise(args[0], packedSqrt, "square root");
+	}
+
 	// The square root of a Complex argument or a negative Number argument
 	std::complex<double> result = (0.0); 
 	bool is_complex = false; // Flag to determine result type
@@ -203,6 +417,11 @@ Expression sqrt(const std::vector<Expression> & args)
 
 Expression a_pow_b(const std::vector<Expression> & args)
 {
+	// Lists are raised element-wise
+	if (nargs_equal(args, 2) && any_list(args)) {
+		return elementwise(args, packedPow, "a_pow_b");
+	}
+
 	// The result should be of type Number only when both arguments are of type Number
 	std::complex<double> result = (0.0);
 	bool is_complex = false; // Flag to determine result type
@@ -246,6 +465,11 @@ Expression a_pow_b(const std::vector<Expression> & args)
 
 Expression nat_log(const std::vector<Expression> & args) {
 
+	// Lists are evaluated element-wise
+	if (nargs_equal(args, 1) && args[0].isHeadList()) {
+		return elementwise(args[0], packedLog, "natural log");
+	}
+
 	double result = 0;
 
 	if (nargs_equal(args, 1)) {
@@ -265,6 +489,11 @@ Expression nat_log(const std::vector<Expression> & args) {
 
 Expression sine(const std::vector<Expression> & args) {
 
+	// Lists are evaluated element-wise
+	if (nargs_equal(args, 1) && args[0].isHeadList()) {
+		return elementwise(args[0], packedSin, "sine");
+	}
+
 	double result = 0;
 
 	if (nargs_equal(args, 1)) {
@@ -283,6 +512,11 @@ Expression sine(const std::vector<Expression> & args) {
 
 Expression cosine(const std::vector<Expression> & args) {
 
+	// Lists are evaluated element-wise
+	if (nargs_equal(args, 1) && args[0].isHeadList()) {
+		return elementwise(args[0], packedCos, "cosine");
+	}
+
 	double result = 0;
 
 	if (nargs_equal(args, 1)) {
@@ -301,6 +535,11 @@ Expression cosine(const std::vector<Expression> & args) {
 
 Expression tangent(const std::vector<Expression> & args) {
 
+	// Lists are evaluated element-wise
+	if (nargs_equal(args, 1) && args[0].isHeadList()) {
+		return elementwise(args[0], packedTan, "tangent");
+	}
+
 	double result = 0;
 
 	if (nargs_equal(args, 1)) {
@@ -317,6 +556,42 @@ Expression tangent(const std::vector<Expression> & args) {
 	return Expression(result);
 };
 
+// The smallest of one or more Number arguments
+Expression minimum(const std::vector<Expression> & args) {
+
+	if (args.empty()) {
+		throw SemanticError("Error in call to min: invalid number of arguments.");
+	}
+
+	double result = 0;
+
+	for (std::size_t i = 0; i < args.size(); i++) {
+		if (!args[i].isHeadNumber()) {
+			throw SemanticError("Error in call to min: invalid argument.");
+		}
+		result = (i == 0) ? args[i].head().asNumber() : std::min(result, args[i].head().asNumber());
+	}
+	return Expression(result);
+};
+
+// The largest of one or more Number arguments
+Expression maximum(const std::vector<Expression> & args) {
+
+	if (args.empty()) {
+		throw SemanticError("Error in call to max: invalid number of arguments.");
+	}
+
+	double result = 0;
+
+	for (std::size_t i = 0; i < args.size(); i++) {
+		if (!args[i].isHeadNumber()) {
+			throw SemanticError("Error in call to max: invalid argument.");
+		}
+		result = (i == 0) ? args[i].head().asNumber() : std::max(result, args[i].head().asNumber());
+	}
+	return Expression(result);
+};
+
 
 Expression get_real_num(const std::vector<Expression> & args)
 {
@@ -439,8 +714,8 @@ Expression get_first(const std::vector<Expression> & args)
 	
 	if(nargs_equal(args,1)){
 		if(args[0].isHeadList()){
-			if(!args[0].asList().empty()){
-				result = args[0].asList().front();
+			if(args[0].listSize() > 0){
+				result = args[0].listAt(0);
 			}
 			else{
 				throw SemanticError("Error: argument to first is an empty list");
@@ -462,13 +737,13 @@ Expression get_first(const std::vector<Expression> & args)
 //if the expression is not a List or is empty.
 Expression get_rest(const std::vector<Expression> & args)
 {
-	std::vector<Expression> result;
+	Expression result;
 
 	if(nargs_equal(args,1)){
 		if(args[0].isHeadList()){
-			if(!args[0].asList().empty()){
-				result = args[0].asList();
-				result.erase(result.begin());
+			if(args[0].listSize() > 0){
+				// shares the entries with the argument rather than copying them
+				result = args[0].listRest();
 			}
 			else{
 				throw SemanticError("Error: argument to rest is an empty list");
@@ -482,7 +757,7 @@ Expression get_rest(const std::vector<Expression> & args)
 		throw SemanticError("Error: invalid number of arguments in call to rest");
 	}
 
-	return Expression(result);
+	return result;
 };
 
 //Add a built-in unary procedure length returning the number of items in a List
@@ -494,7 +769,7 @@ Expression get_length(const std::vector<Expression> & args)
 	
 	if(nargs_equal(args,1)) {
 		if(args[0].isHeadList()) {
-			result = args[0].asList().size();
+			result = args[0].listSize();
 		}
 		else {      
 			throw SemanticError("Error: argument to length is not a list");
@@ -512,12 +787,12 @@ Expression get_length(const std::vector<Expression> & args)
 //is not a List.
 Expression make_append(const std::vector<Expression> & args)
 {
-	std::vector<Expression> result;
+	Expression result;
 
 	if(nargs_equal(args, 2)) {
 		if(args[0].isHeadList()) {
-			result = args[0].asList();
-			result.push_back(args[1]);
+			// extends the argument's entries in place when no other List has
+			result = args[0].listAppend(args[1]);
 		}
 		else {
 			throw SemanticError("Error: first argument to append is not a list");
@@ -527,25 +802,19 @@ Expression make_append(const std::vector<Expression> & args)
 		throw SemanticError("Error: invalid number of arguments in call to append");
 	}
 
-	return Expression(result);
+	return result;
 };
 
 //Add a built-in binary procedure join that joins each of the List arguments into
 //one list. It is a semantic error if any argument is not a List.
 Expression make_join(const std::vector<Expression> & args)
 {
-	std::vector<Expression> result;
-	std::vector<Expression> listArgs;
+	Expression result;
 
 	if(nargs_equal(args, 2)) {
 		if( (args[0].isHeadList()) && (args[1].isHeadList()) ) {
-			// Store values in local variable for readability
-			result = args[0].asList();
-			listArgs = args[1].asList();
-			
-			for (auto & exp : listArgs) {
-				result.push_back(exp);
-			}
+			// only the second List's entries are copied
+			result = args[0].listJoin(args[1]);
 		}
 		else {
 			throw SemanticError("Error: argument to join is not a list");
@@ -555,7 +824,7 @@ Expression make_join(const std::vector<Expression> & args)
 		throw SemanticError("Error: invalid number of arguments in call to join");
 	}
 
-	return Expression(result);
+	return result;
 };
 
 //Add a built-in procedure range that produces a list of Numbers from a lower-bound
@@ -565,7 +834,13 @@ Expression make_join(const std::vector<Expression> & args)
 //strictly positive.
 Expression make_range(const std::vector<Expression> & args)
 {
-	std::vector<Expression> results;
+	// Guard the entry count so every index converts to a double exactly
+	const double MAX_ENTRIES = 9007199254740992.0; // 2^53
+
+	// Ranges with fractional increments up to this long are counted by stepping
+	const double STEPPED_MAX = 16777216.0; // 2^24
+
+	Expression results;
 
 	if(nargs_equal(args,3)) {
 		if((args[0].isHeadNumber()) && (args[1].isHeadNumber()) && (args[2].isHeadNumber())){
@@ -576,9 +851,34 @@ Expression make_range(const std::vector<Expression> & args)
 			
 			if(low < high) {
 				if(inc > 0) {
-					for (double sum = low; sum <= high; sum += inc) {
-						results.push_back(Atom(sum));
+					// Count the entries up front. The division can round either way,
+					// so settle the count on the entries themselves: the last one
+					// must not pass high, and the one after it must
+					double count = std::floor((high - low) / inc) + 1;
+					if(count > MAX_ENTRIES){
+						throw SemanticError("Error: too many entries in range");
+					}
+					while((count < MAX_ENTRIES) && (low + count * inc <= high)){
+						count += 1;
+					}
+					while((count > 1) && (low + (count - 1) * inc > high)){
+						count -= 1;
 					}
+
+					// Integer steps are exact, but fractional ones round as they
+					// accumulate, and ranges have always been counted by stepping
+					// from low until past high. Step the same way, so rounding near
+					// high keeps or drops the last entry as it always has; a range
+					// too long to have been built entry by entry keeps the estimate.
+					if(((low != std::floor(low)) || (inc != std::floor(inc))) && (count <= STEPPED_MAX)){
+						double stepped = 0;
+						double x = low;
+						for(; (x <= high) && (stepped <= count + 1); x += inc){
+							stepped += 1;
+						}
+						if(x > high) count = stepped;
+					}
+					results = Expression::makeRange(low, high, inc, static_cast<std::size_t>(count));
 				}
 				else {
 					throw SemanticError("Error: negative or zero increment in range");
@@ -596,10 +896,320 @@ Expression make_range(const std::vector<Expression> & args)
 		throw SemanticError("Error: invalid number of arguments in range");
 	}
   
+	return results;
+};
+
+/*
+ * Pack the List of Numbers that is the first argument of a statistics
+ * procedure. It is a semantic error if there are not nargs arguments, or the
+ * first is not a non-empty List of Numbers (or Complex values, when
+ * allowComplex is set).
+ */
+PackedArray pack_data(const std::vector<Expression> & args, unsigned nargs,
+                      const std::string & name, bool allowComplex = false)
+{
+	if(!nargs_equal(args, nargs)){
+		throw SemanticError("Error: invalid number of arguments in call to " + name);
+	}
+
+	PackedArray values;
+	if(!args[0].isHeadList() || !pack(args[0], values) || (values.size() == 0)){
+		throw SemanticError("Error: first argument to " + name + " is not a non-empty list of numbers");
+	}
+
+	if(values.anyComplex && !allowComplex){
+		for(auto flag : values.complex){
+			if(flag){
+				throw SemanticError("Error: first argument to " + name + " is not a non-empty list of numbers");
+			}
+		}
+	}
+
+	return values;
+}
+
+//Add a built-in unary procedure sum returning the sum of a List of Numbers (or
+//Complex values).
+Expression get_sum(const std::vector<Expression> & args)
+{
+	PackedArray values = pack_data(args, 1, "sum", true);
+
+	Expression result;
+	packedReduce(values, Reduction::Sum, result);
+
+	return result;
+};
+
+//Add a built-in unary procedure mean returning the arithmetic mean of a List of
+//Numbers (or Complex values).
+Expression get_mean(const std::vector<Expression> & args)
+{
+	PackedArray values = pack_data(args, 1, "mean", true);
+
+	Expression sum;
+	packedReduce(values, Reduction::Sum, sum);
+
+	double n = static_cast<double>(values.size());
+	if(sum.isHeadComplex()){
+		return Expression(sum.head().asComplex() / n);
+	}
+	return Expression(sum.head().asNumber() / n);
+};
+
+//Add a built-in unary procedure stddev returning the population standard
+//deviation of a List of Numbers.
+Expression get_stddev(const std::vector<Expression> & args)
+{
+	PackedArray values = pack_data(args, 1, "stddev");
+
+	Moments m = packedMoments(values);
+
+	return Expression(std::sqrt(m.m2 / m.count));
+};
+
+//Add a built-in unary procedure minmax returning a List of the smallest and
+//largest entries of a List of Numbers.
+Expression get_minmax(const std::vector<Expression> & args)
+{
+	PackedArray values = pack_data(args, 1, "minmax");
+
+	Expression lo, hi;
+	packedReduce(values, Reduction::Min, lo);
+	packedReduce(values, Reduction::Max, hi);
+
+	return Expression(Expression::List{ lo, hi });
+};
+
+//Add a built-in binary procedure quantiles returning, for each probability in
+//the List second argument, the quantile of a List of Numbers, interpolating
+//linearly between the closest entries. It is a semantic error if a
+//probability is not a Number from 0 to 1, or if an entry is not finite.
+Expression get_quantiles(const std::vector<Expression> & args)
+{
+	PackedArray values = pack_data(args, 2, "quantiles");
+
+	if(!args[1].isHeadList()){
+		throw SemanticError("Error: second argument to quantiles is not a list");
+	}
+
+	// NaN has no place in a sorted order, and sorting it is undefined
+	for(double x : values.re){
+		if(!std::isfinite(x)){
+			throw SemanticError("Error: first argument to quantiles contains a value that is not finite");
+		}
+	}
+
+	// the sort itself runs to completion, so check on either side of it
+	CancellationToken::check();
+	std::vector<double> sorted = values.re;
+	std::sort(sorted.begin(), sorted.end());
+	CancellationToken::check();
+
+	Expression::List results;
+	for(std::size_t i = 0; i < args[1].listSize(); i++){
+		Expression p = args[1].listAt(i);
+		if(!p.isHeadNumber() || (p.head().asNumber() < 0) || (p.head().asNumber() > 1)){
+			throw SemanticError("Error: invalid probability in call to quantiles");
+		}
+
+		double position = p.head().asNumber() * (sorted.size() - 1);
+		std::size_t below = static_cast<std::size_t>(std::floor(position));
+		std::size_t above = std::min(below + 1, sorted.size() - 1);
+		double fraction = position - below;
+
+		results.push_back(Expression(sorted[below] + fraction * (sorted[above] - sorted[below])));
+	}
+
+	return Expression(results);
+};
+
+//Add a built-in binary procedure histogram counting a List of Numbers into the
+//given (positive integer) number of equal-width bins spanning the data. It
+//returns a List of (center count) Lists, one per bin, ready for discrete-plot.
+Expression make_histogram(const std::vector<Expression> & args)
+{
+	PackedArray values = pack_data(args, 2, "histogram");
+
+	if(!args[1].isHeadNumber() || (args[1].head().asNumber() < 1)
+	   || (args[1].head().asNumber() != std::floor(args[1].head().asNumber())))
+	{
+		throw SemanticError("Error: second argument to histogram is not a positive integer");
+	}
+	std::size_t bins = static_cast<std::size_t>(args[1].head().asNumber());
+
+	// an infinite or NaN entry has no bin, and would make every bin infinitely wide
+	for(double x : values.re){
+		if(!std::isfinite(x)){
+			throw SemanticError("Error: first argument to histogram contains a value that is not finite");
+		}
+	}
+
+	Expression lo, hi;
+	packedReduce(values, Reduction::Min, lo);
+	packedReduce(values, Reduction::Max, hi);
+
+	double low = lo.head().asNumber();
+	double width = (hi.head().asNumber() - low) / bins;
+	std::vector<std::size_t> counts = packedHistogram(values, low, hi.head().asNumber(), bins);
+
+	Expression::List results;
+	for(std::size_t i = 0; i < bins; i++){
+		Expression center(low + (i + 0.5) * width);
+		Expression count(static_cast<double>(counts[i]));
+		results.push_back(Expression(Expression::List{ center, count }));
+	}
+
 	return Expression(results);
 };
 
+//Add a built-in unary procedure fft returning the discrete Fourier transform,
+//as a List of Complex values, of a List of Numbers (or Complex values) of any
+//length.
+Expression get_fft(const std::vector<Expression> & args)
+{
+	PackedArray values = pack_data(args, 1, "fft", true);
+
+	packedFFT(values, false);
+
+	return unpack(values);
+};
+
+//Add a built-in unary procedure ifft returning the inverse discrete Fourier
+//transform, scaled by 1/N, of a List of Numbers (or Complex values).
+Expression get_ifft(const std::vector<Expression> & args)
+{
+	PackedArray values = pack_data(args, 1, "ifft", true);
+
+	packedFFT(values, true);
 
+	return unpack(values);
+};
+
+//Add a built-in binary procedure convolve returning the full linear
+//convolution of two Lists of Numbers (or Complex values), of length
+//N + M - 1.
+Expression make_convolve(const std::vector<Expression> & args)
+{
+	PackedArray a = pack_data(args, 2, "convolve", true);
+
+	PackedArray b;
+	if(!args[1].isHeadList() || !pack(args[1], b) || (b.size() == 0)){
+		throw SemanticError("Error: second argument to convolve is not a non-empty list of numbers");
+	}
+
+	PackedArray result;
+	packedConvolve(a, b, result);
+
+	return unpack(result);
+};
+
+//Add a built-in binary procedure moving-average returning the mean of each
+//run of WIDTH consecutive entries of a List of Numbers (or Complex values). It
+//is a semantic error if WIDTH is not a positive integer no larger than the
+//length of the List.
+Expression make_moving_average(const std::vector<Expression> & args)
+{
+	PackedArray values = pack_data(args, 2, "moving-average", true);
+
+	if(!args[1].isHeadNumber() || (args[1].head().asNumber() < 1)
+	   || (args[1].head().asNumber() != std::floor(args[1].head().asNumber()))
+	   || (args[1].head().asNumber() > values.size()))
+	{
+		throw SemanticError("Error: invalid window width in call to moving-average");
+	}
+	std::size_t width = static_cast<std::size_t>(args[1].head().asNumber());
+
+	PackedArray result;
+	packedMovingAverage(values, width, result);
+
+	return unpack(result);
+};
+
+
+
+//Add a built-in unary procedure matrix converting a List of rows, each a List
+//of Numbers of the same length, into a Matrix.
+Expression make_matrix(const std::vector<Expression> & args)
+{
+	if(!nargs_equal(args, 1)){
+		throw SemanticError("Error: invalid number of arguments in call to matrix");
+	}
+
+	Matrix m;
+	if(!toMatrix(args[0], m)){
+		throw SemanticError("Error: argument to matrix is not a list of equal-length lists of numbers");
+	}
+
+	return Expression::makeMatrix(std::move(m));
+};
+
+// the Matrix argument i of a Matrix procedure, or a semantic error
+const Matrix & matrix_arg(const std::vector<Expression> & args, std::size_t i,
+                          unsigned nargs, const std::string & name)
+{
+	if(!nargs_equal(args, nargs)){
+		throw SemanticError("Error: invalid number of arguments in call to " + name);
+	}
+	if(!args[i].isHeadMatrix()){
+		throw SemanticError("Error: argument to " + name + " is not a matrix");
+	}
+
+	return *args[i].asMatrix();
+}
+
+//Add a built-in unary procedure matrix-to-list converting a Matrix back into
+//a List of rows, each a List of Numbers.
+Expression get_matrix_list(const std::vector<Expression> & args)
+{
+	return fromMatrix(matrix_arg(args, 0, 1, "matrix-to-list"));
+};
+
+//Add a built-in binary procedure matmul returning the matrix product of two
+//Matrices. It is a semantic error if the columns of the first do not match
+//the rows of the second.
+Expression get_matmul(const std::vector<Expression> & args)
+{
+	const Matrix & a = matrix_arg(args, 0, 2, "matmul");
+	const Matrix & b = matrix_arg(args, 1, 2, "matmul");
+
+	Matrix result;
+	if(!matmul(a, b, result)){
+		throw SemanticError("Error in call to matmul: matrices of incompatible shape");
+	}
+
+	return Expression::makeMatrix(std::move(result));
+};
+
+//Add a built-in unary procedure transpose returning the transpose of a Matrix.
+Expression get_transpose(const std::vector<Expression> & args)
+{
+	return Expression::makeMatrix(transpose(matrix_arg(args, 0, 1, "transpose")));
+};
+
+// a List of Numbers
+Expression make_number_list(const std::vector<double> & values)
+{
+	Expression::List items;
+	items.reserve(values.size());
+	for(double v : values){
+		items.emplace_back(Atom(v));
+	}
+	return Expression(items);
+}
+
+//Add a built-in unary procedure row-sums returning a List of the sums of each
+//row of a Matrix.
+Expression get_row_sums(const std::vector<Expression> & args)
+{
+	return make_number_list(rowSums(matrix_arg(args, 0, 1, "row-sums")));
+};
+
+//Add a built-in unary procedure column-sums returning a List of the sums of
+//each column of a Matrix.
+Expression get_column_sums(const std::vector<Expression> & args)
+{
+	return make_number_list(columnSums(matrix_arg(args, 0, 1, "column-sums")));
+};
 
 /*
  * (discrete-plot DATA OPTIONS)
@@ -615,8 +1225,19 @@ Expression make_range(const std::vector<Expression> & args)
  *                        ordinate (vertical, y) label.
  *    "text-scale"      - positive Number representing the scale factor to
  *                        apply to all text in the plot, defaults to 1.
+ *    "point-budget"    - whole Number, at least 2, of data points to draw,
+ *                        defaults to 4000.
  *
  * It returns a List of Graphic objects that render a stem plot of the data.
+ * Data with more points than the budget is decimated, keeping the extremes
+ * of each of budget / 2 equal slices of the x range; the number of points
+ * left out is then the "dropped-points" property of the result. A plot that
+ * drew every point has no such property.
+ *
+ * A plot drawing at most 256 (LayoutParams::batch) points has one "point"
+ * and one "line" item per point. In a larger plot those are replaced by a
+ * single "point-cloud" item holding every point and a single "polyline"
+ * item holding every stem; the box, axes and text items are unchanged.
 */
 Expression discrete_plot(const std::vector<Expression> & args)
 {
@@ -625,16 +1246,18 @@ Expression discrete_plot(const std::vector<Expression> & args)
   // being a String Expression followed by an arbitrary Expression
   
 	Expression::List result; // List of Lines, Points, and Text Graphic objects
+	std::size_t dropped = 0;  // Data points left out by decimation
 
 	if(nargs_equal(args, 2)){
 		if( (args[0].isHeadList()) && (args[1].isHeadList()) ){
-			// Store values in local variable for readability
-			Expression::List data = args[0].asList();
+			// Store values in local variable for readability, the data is
+			// read in place rather than copied
+			const Expression & data = args[0];
 			Expression::List options = args[1].asList();
 			
 			try {
-				Expression::List temp = Expression::makeDiscretePlot(data, options);
-				result = temp;
+				Expression::List temp = Expression::makeDiscretePlot(data, options, dropped);
+				result.swap(temp);
 			}
 			catch (const SemanticError & ex) {
 				throw ex; // Re-throw error? Idk if this helps or not
@@ -649,16 +1272,124 @@ Expression discrete_plot(const std::vector<Expression> & args)
 		throw SemanticError("Error: invalid number of arguments in call to discrete-plot");
 	}
 
-	return Expression(result);
+	Expression plot(result);
+	if(dropped > 0){
+		plot.setProperty("\"dropped-points\"", Expression(static_cast<double>(dropped)));
+	}
+
+	return plot;
+};
+
+/*
+ * (make-point X Y), (make-line P1 P2), (make-text STR)
+ * Graphic primitive constructors. Each returns its arguments as a List (or
+ * the String itself for make-text) with the "object-name" property set to
+ * "point", "line" or "text" respectively.
+ */
+Expression make_point(const std::vector<Expression> & args)
+{
+	if(!nargs_equal(args, 2)){
+		throw SemanticError("Error: invalid number of arguments in call to make-point");
+	}
+
+	return Expression::makePointG(args[0], args[1]);
+};
+
+Expression make_line(const std::vector<Expression> & args)
+{
+	if(!nargs_equal(args, 2)){
+		throw SemanticError("Error: invalid number of arguments in call to make-line");
+	}
+
+	return Expression::makeLineG(args[0], args[1]);
+};
+
+Expression make_text(const std::vector<Expression> & args)
+{
+	if(!nargs_equal(args, 1)){
+		throw SemanticError("Error: invalid number of arguments in call to make-text");
+	}
+
+	return Expression::makeTextG(args[0]);
 };
 
 /***********************************************************************
 Built-In Symbols
 **********************************************************************/
 
-const double PI = std::atan2(0, -1);
-const double EXP = std::exp(1);
-const std::complex<double> IMAG = std::complex<double>(0.0, 1.0);
+// spelled out to double precision so the tables below are compile-time
+// constants rather than being computed by static initializers
+constexpr double PI = 3.141592653589793238462643383279502884;
+constexpr double EXP = 2.718281828459045235360287471352662498;
+constexpr std::complex<double> IMAG = std::complex<double>(0.0, 1.0);
+
+// A built-in symbol and the value it is bound to by default
+struct BuiltInSymbol {
+  const char * name;
+  std::complex<double> value;
+  bool isComplex;
+
+  Atom atom() const { return isComplex ? Atom(value) : Atom(value.real()); }
+};
+
+// A built-in procedure and the name it is bound to by default
+struct BuiltInProcedure {
+  const char * name;
+  Procedure proc;
+};
+
+constexpr BuiltInSymbol BUILTIN_SYMBOLS[] = {
+  {"pi", PI,   false},  // Built-In value of pi
+  {"e",  EXP,  false},  // Built-In value of Euler's Number
+  {"I",  IMAG, true}    // Built-In value of Complex symbol I
+};
+
+constexpr BuiltInProcedure BUILTIN_PROCEDURES[] = {
+  {"+",             add},
+  {"-",             subneg},
+  {"*",             mul},
+  {"/",             div},
+  {"sqrt",          sqrt},
+  {"^",             a_pow_b},
+  {"ln",            nat_log},
+  {"sin",           sine},
+  {"cos",           cosine},
+  {"tan",           tangent},
+  {"min",           minimum},
+  {"max",           maximum},
+  {"real",          get_real_num},
+  {"imag",          get_imag_num},
+  {"mag",           get_mag},
+  {"arg",           get_arg},
+  {"conj",          get_conj},
+  {"list",          make_list},
+  {"first",         get_first},
+  {"rest",          get_rest},
+  {"length",        get_length},
+  {"append",        make_append},
+  {"join",          make_join},
+  {"range",         make_range},
+  {"sum",           get_sum},
+  {"mean",          get_mean},
+  {"stddev",        get_stddev},
+  {"minmax",        get_minmax},
+  {"quantiles",     get_quantiles},
+  {"histogram",     make_histogram},
+  {"fft",           get_fft},
+  {"ifft",          get_ifft},
+  {"convolve",      make_convolve},
+  {"moving-average", make_moving_average},
+  {"matrix",        make_matrix},
+  {"matrix-to-list", get_matrix_list},
+  {"matmul",        get_matmul},
+  {"transpose",     get_transpose},
+  {"row-sums",      get_row_sums},
+  {"column-sums",   get_column_sums},
+  {"discrete-plot", discrete_plot},
+  {"make-point",    make_point},
+  {"make-line",     make_line},
+  {"make-text",     make_text}
+};
 
 /***********************************************************************
 Public Methods
@@ -671,22 +1402,37 @@ Environment::Environment(){
 }
 
 Environment::Environment(const Environment & env){
-  // Copy all mapped values using std::map::operator=
+  // Share all mapped values until either side changes them
   envmap = env.envmap;
   isLambda = true;
+
+  // Identical bindings, so call-site caches stay valid in the copy
+  procVersion = env.procVersion;
+  expVersion = env.expVersion;
+}
+
+Environment & Environment::operator=(const Environment & env){
+
+  // Share all mapped values until either side changes them
+  envmap = env.envmap;
+  isLambda = env.isLambda;
+  procVersion = env.procVersion;
+  expVersion = env.expVersion;
+
+  return *this;
 }
 
 bool Environment::is_known(const Atom & sym) const{
   if(!sym.isSymbol()) return false;
   
-  return envmap.find(sym.asSymbol()) != envmap.end();
+  return envmap->find(sym.asSymbol()) != envmap->end();
 }
 
 bool Environment::is_exp(const Atom & sym) const{
   if(!sym.isSymbol()) return false;
   
-  auto result = envmap.find(sym.asSymbol());
-  return (result != envmap.end()) && (result->second.type == ExpressionType);
+  auto result = envmap->find(sym.asSymbol());
+  return (result != envmap->end()) && (result->second.type == ExpressionType);
 }
 
 Expression Environment::get_exp(const Atom & sym) const{
@@ -694,8 +1440,8 @@ Expression Environment::get_exp(const Atom & sym) const{
   Expression exp;
   
   if(sym.isSymbol()){
-    auto result = envmap.find(sym.asSymbol());
-    if((result != envmap.end()) && (result->second.type == ExpressionType)){
+    auto result = envmap->find(sym.asSymbol());
+    if((result != envmap->end()) && (result->second.type == ExpressionType)){
       exp = result->second.exp;
     }
   }
@@ -710,40 +1456,64 @@ void Environment::add_exp(const Atom & sym, const Expression & exp){
   }
 
   // error if overwriting symbol map
-  if(envmap.find(sym.asSymbol()) != envmap.end()){
-    if(isLambda){
-      // Rule exception
-	  EnvResult newValue(ExpressionType, exp);
-	  std::swap(envmap.at(sym.asSymbol()), newValue);
-	}
-	else{
-	  throw SemanticError("Error: Attempt to overwrite symbol in environemnt");
-	}
+  auto found = envmap->find(sym.asSymbol());
+  if((found != envmap->end()) && (!isLambda)){
+	throw SemanticError("Error: Attempt to overwrite symbol in environemnt");
   }
-  else{
-    envmap.emplace(sym.asSymbol(), EnvResult(ExpressionType, exp));
+
+  // only a change to what some symbol names as a lambda invalidates cached
+  // lambdas, so binding ordinary values such as parameters keeps them
+  if(exp.isHeadLambda() || ((found != envmap->end()) && found->second.exp.isHeadLambda())){
+    expVersion = next_version();
+  }
+
+  // Shadowing a procedure also invalidates cached procedures
+  if((found != envmap->end()) && (found->second.type == ProcedureType)){
+    procVersion = next_version();
+  }
+
+  // never change bindings that another fork can still see
+  detach();
+
+  // Rule exception: Lambda shadow Environments may overwrite
+  EnvResult newValue(ExpressionType, exp);
+  auto result = envmap->emplace(sym.asSymbol(), newValue);
+  if(!result.second){
+	std::swap(result.first->second, newValue);
   }
 }
 
+std::shared_ptr<Expression> Environment::get_lambda(const Atom & sym) const{
+
+  if(sym.isSymbol()){
+    auto result = envmap->find(sym.asSymbol());
+    if((result != envmap->end()) && (result->second.type == ExpressionType)){
+      return result->second.lambda;
+    }
+  }
+
+  return nullptr;
+}
+
 bool Environment::is_proc(const Atom & sym) const{
   if(!sym.isSymbol()) return false;
   
-  auto result = envmap.find(sym.asSymbol());
-  return (result != envmap.end()) && (result->second.type == ProcedureType);
+  auto result = envmap->find(sym.asSymbol());
+  return (result != envmap->end()) && (result->second.type == ProcedureType);
 }
 
 bool Environment::is_anon_proc(const Atom & sym) const{
   if(!sym.isSymbol()) return false;
 
-  auto result = envmap.find(sym.asSymbol());
-  return (result != envmap.end()) && (result->second.exp.isHeadLambda());
+  auto result = envmap->find(sym.asSymbol());
+  return (result != envmap->end()) && (result->second.exp.isHeadLambda());
 }
 
 Procedure Environment::get_proc(const Atom & sym) const{
 
   if(sym.isSymbol()){
-    auto result = envmap.find(sym.asSymbol());
-    if((result != envmap.end()) && (result->second.type == ProcedureType)){
+    auto result = envmap->find(sym.asSymbol());
+    if((result != envmap->end()) && (result->second.type == ProcedureType)){
       return result->second.proc;
     }
   }
@@ -752,96 +1522,70 @@ Procedure Environment::get_proc(const Atom & sym) const{
 }
 
 /*
-Reset the environment to the default state. First remove all entries and
-then re-add the default ones.
+Reset the environment to the default state. The default bindings are built
+once from the constant tables above and then shared copy-on-write, so a
+reset only swaps in the shared map.
  */
 void Environment::reset(){
 
-  envmap.clear();
-  
-  // Built-In value of pi
-  envmap.emplace("pi", EnvResult(ExpressionType, Expression(PI)));
-
-  // Built-In value of Euler's Number
-  envmap.emplace("e", EnvResult(ExpressionType, Expression(EXP)));
-
-  // Built-In value of Complex symbol I
-  envmap.emplace("I", EnvResult(ExpressionType, Expression(IMAG)));
-
-  // Procedure: add;
-  envmap.emplace("+", EnvResult(ProcedureType, add)); 
-
-  // Procedure: subneg;
-  envmap.emplace("-", EnvResult(ProcedureType, subneg)); 
-
-  // Procedure: mul;
-  envmap.emplace("*", EnvResult(ProcedureType, mul)); 
-
-  // Procedure: div;
-  envmap.emplace("/", EnvResult(ProcedureType, div)); 
-
-  // Procedure: sqrt;
-  envmap.emplace("sqrt", EnvResult(ProcedureType, sqrt));
+  static const std::shared_ptr<EnvMap> defaults = [](){
+    std::shared_ptr<EnvMap> result = std::make_shared<EnvMap>();
 
-  // Procedure: (^ a b);
-  envmap.emplace("^", EnvResult(ProcedureType, a_pow_b));
-
-  // Procedure: ln;
-  envmap.emplace("ln", EnvResult(ProcedureType, nat_log));
-
-  // Procedure: sin;
-  envmap.emplace("sin", EnvResult(ProcedureType, sine));
-
-  // Procedure: cos;
-  envmap.emplace("cos", EnvResult(ProcedureType, cosine));
-
-  // Procedure: tan;
-  envmap.emplace("tan", EnvResult(ProcedureType, tangent));
-
-  // Procedure: real;
-  envmap.emplace("real", EnvResult(ProcedureType, get_real_num));
-
-  // Procedure: imag;
-  envmap.emplace("imag", EnvResult(ProcedureType, get_imag_num));
+    for(auto & symbol : BUILTIN_SYMBOLS){
+      result->emplace(symbol.name, EnvResult(ExpressionType, Expression(symbol.atom())));
+    }
 
-  // Procedure: mag;
-  envmap.emplace("mag", EnvResult(ProcedureType, get_mag));
+    for(auto & builtin : BUILTIN_PROCEDURES){
+      result->emplace(builtin.name, EnvResult(ProcedureType, builtin.proc));
+    }
 
-  // Procedure: arg;
-  envmap.emplace("arg", EnvResult(ProcedureType, get_arg));
+    return result;
+  }();
 
-  // Procedure: conj;
-  envmap.emplace("conj", EnvResult(ProcedureType, get_conj));
+  envmap = defaults;
+  procVersion = next_version();
+  expVersion = next_version();
+}
 
-  // Procedure: list;
-  envmap.emplace("list", EnvResult(ProcedureType, make_list));
+void Environment::isolate(){
 
-  // Procedure: first;
-  envmap.emplace("first", EnvResult(ProcedureType, get_first));
+  bool shared = false;
+  for(auto & entry : *envmap){
+    if(entry.second.lambda) shared = true;
+  }
+  if(!shared) return;
 
-  // Procedure: rest;
-  envmap.emplace("rest", EnvResult(ProcedureType, get_rest));
+  // the copies are unlinked, and hold the same lambdas, so the stamps stay
+  detach();
+  for(auto & entry : *envmap){
+    if(entry.second.lambda){
+      entry.second.lambda = std::make_shared<Expression>(entry.second.exp);
+    }
+  }
+}
 
-  // Procedure: length;
-  envmap.emplace("length", EnvResult(ProcedureType, get_length));
+unsigned long Environment::proc_version() const noexcept{
+  return procVersion;
+}
 
-  // Procedure: append;
-  envmap.emplace("append", EnvResult(ProcedureType, make_append));
+unsigned long Environment::exp_version() const noexcept{
+  return expVersion;
+}
 
-  // Procedure: join;
-  envmap.emplace("join", EnvResult(ProcedureType, make_join));
+bool Environment::operator==(const Environment & env) const noexcept{
 
-  // Procedure: range;
-  envmap.emplace("range", EnvResult(ProcedureType, make_range));
+  // Forks that share a map are equal without comparing each entry
+  if(envmap == env.envmap) return true;
 
-  // Procedure: discrete-plot;
-  envmap.emplace("discrete-plot", EnvResult(ProcedureType, discrete_plot));
+  // Comparison should work using just the std::map::operator==
+  return (*envmap == *env.envmap);
 }
 
-bool Environment::operator==(const Environment & env) const noexcept{
+void Environment::detach(){
 
-  // Comparison should work using just the std::map::operator==
-  return (envmap == env.envmap);
+  if(envmap.use_count() > 1){
+    envmap = std::make_shared<EnvMap>(*envmap);
+  }
 }
 
 bool operator!=(const Environment & left, const Environment & right) noexcept{
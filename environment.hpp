@@ -12,6 +12,7 @@ needed.
 
 // system includes
 #include <map>
+#include <memory>
 
 // module includes
 #include "atom.hpp"
@@ -21,12 +22,6 @@ needed.
 #include <vector>
 #include <string>
 
-/*! \typedef Procedure
-\brief A Procedure is a C++ function pointer taking a vector of 
-       Expressions as arguments and returning an Expression.
-*/
-typedef Expression (*Procedure)(const std::vector<Expression> & args);
-
 /*! \class Environment
 \brief A class representing the interpreter environment.
 
@@ -50,6 +45,11 @@ public:
   // Copy constructor for Lambda
   Environment(const Environment & env);
 
+  /*! Fork an environment in O(1). The bindings are shared copy-on-write,
+    so neither side sees later changes made by the other.
+   */
+  Environment & operator=(const Environment & env);
+
   /*! Determine if a symbol is known to the environment.
     \param sym the sumbol to lookup
     \return true if the symbol has been defined in the environment
@@ -69,6 +69,13 @@ public:
   */
   Expression get_exp(const Atom &sym) const;
 
+  /*! Get the lambda the argument symbol maps to, without copying it.
+    \param sym the symbol to lookup
+    \return the bound lambda, shared with every call site linked to it, or
+    nullptr if sym does not map to a lambda
+   */
+  std::shared_ptr<Expression> get_lambda(const Atom &sym) const;
+
   /*! Add a mapping from sym argument to the exp argument within the environment.
     \param sym the symbol to add
     \param exp the expression the symbol should map to
@@ -98,6 +105,27 @@ public:
 
   /*! Reset the environment to its default state. */
   void reset();
+
+  /*! Give this environment its own copy of every bound lambda, so call
+    sites evaluated on this thread never link into lambdas another thread
+    is evaluating. The other bindings stay shared.
+   */
+  void isolate();
+
+  /*! Version stamp of the procedure bindings, used by call-site caches.
+    \return a stamp that changes whenever reset or add_exp replaces a
+    procedure binding. Environments sharing a stamp map every procedure
+    symbol to the same Procedure.
+   */
+  unsigned long proc_version() const noexcept;
+
+  /*! Version stamp of the lambda bindings, used by call-site caches.
+    \return a stamp that changes whenever reset runs or add_exp binds a
+    symbol to a lambda or rebinds one that was. Binding other values, such
+    as lambda parameters, keeps it. Environments sharing a stamp map every
+    symbol bound to a lambda to the same lambda.
+   */
+  unsigned long exp_version() const noexcept;
   
   // equality comparison for two environments (recursive)
   bool operator==(const Environment & env) const noexcept;
@@ -112,9 +140,14 @@ private:
     Expression exp; // used when type is ExpressionType
     Procedure proc; // used when type is ProcedureType
 
+    // the same lambda as exp when exp is one, linked in place by call sites
+    std::shared_ptr<Expression> lambda;
+
     // constructors for use in container emplace
     EnvResult(){};
-    EnvResult(EnvResultType t, Expression e) : type(t), exp(e){};
+    EnvResult(EnvResultType t, Expression e) : type(t), exp(e){
+      if(exp.isHeadLambda()) lambda = std::make_shared<Expression>(exp);
+    };
     EnvResult(EnvResultType t, Procedure p) : type(t), proc(p){};
     
     // equality comparison for two EnvResult objects (idk if necessary)
@@ -126,11 +159,19 @@ private:
     };
   };
 
-  // the environment map
-  std::map<std::string, EnvResult> envmap;
+  // the environment map, shared copy-on-write between forked environments
+  typedef std::map<std::string, EnvResult> EnvMap;
+  std::shared_ptr<EnvMap> envmap;
+
+  // take a private copy of a shared map before changing it
+  void detach();
 
   // Flag to allow overwriting variables in a Lambda shadow Environment
   bool isLambda;
+
+  // Version stamps checked by the inline caches in Expression::apply
+  unsigned long procVersion;
+  unsigned long expVersion;
 };
 
 /// inequality comparison for two environments (recursive)
@@ -44,6 +44,10 @@ TEST_CASE( "Test default constructor", "[environment]" )
   REQUIRE(env.is_proc(Atom("append")));
   REQUIRE(env.is_proc(Atom("join")));
   REQUIRE(env.is_proc(Atom("range")));
+
+  REQUIRE(env.is_proc(Atom("make-point")));
+  REQUIRE(env.is_proc(Atom("make-line")));
+  REQUIRE(env.is_proc(Atom("make-text")));
   REQUIRE(!env.is_proc(Atom("op")));
 }
 
@@ -145,3 +149,64 @@ TEST_CASE( "Test semantic errors", "[environment]" )
   }
 }
 
+
+TEST_CASE( "Test version stamps", "[environment]" )
+{
+  Environment env;
+  unsigned long procVersion = env.proc_version();
+  unsigned long expVersion = env.exp_version();
+
+  INFO("A copy shares the bindings and so the stamps");
+  Environment shadow(env);
+  REQUIRE(shadow.proc_version() == procVersion);
+  REQUIRE(shadow.exp_version() == expVersion);
+
+  INFO("Adding a value that is not a lambda changes neither stamp");
+  env.add_exp(Atom("one"), Expression(1.0));
+  REQUIRE(env.proc_version() == procVersion);
+  REQUIRE(env.exp_version() == expVersion);
+
+  INFO("Adding a lambda only changes the lambda stamp");
+  Expression lambda(Atom("lambda"));
+  lambda.append(Expression(Atom("list")));
+  lambda.append(Expression(1.0));
+  env.add_exp(Atom("f"), lambda);
+  REQUIRE(env.proc_version() == procVersion);
+  REQUIRE(env.exp_version() != expVersion);
+  REQUIRE(env.get_lambda(Atom("f")) != nullptr);
+  REQUIRE(*env.get_lambda(Atom("f")) == lambda);
+  REQUIRE(env.get_lambda(Atom("one")) == nullptr);
+
+  INFO("Shadowing a procedure with a value changes only the procedure stamp");
+  shadow.add_exp(Atom("+"), Expression(1.0));
+  REQUIRE(shadow.proc_version() != procVersion);
+  REQUIRE(shadow.exp_version() == expVersion);
+
+  INFO("Reset changes both stamps");
+  env.reset();
+  REQUIRE(env.proc_version() != procVersion);
+  REQUIRE(env.exp_version() != expVersion);
+}
+
+TEST_CASE( "Test copy-on-write fork", "[environment]" )
+{
+  Environment env;
+  env.add_exp(Atom("one"), Expression(1.0));
+
+  Environment fork;
+  fork = env;
+  REQUIRE(fork == env);
+
+  INFO("Changes to the fork are not seen by the original");
+  fork.add_exp(Atom("two"), Expression(2.0));
+  REQUIRE(fork.is_exp(Atom("two")));
+  REQUIRE(!env.is_known(Atom("two")));
+
+  INFO("Changes to the original are not seen by the fork");
+  env.add_exp(Atom("three"), Expression(3.0));
+  REQUIRE(!fork.is_known(Atom("three")));
+
+  INFO("A fork of a global environment still refuses redefinition");
+  REQUIRE_THROWS_AS(fork.add_exp(Atom("one"), Expression(4.0)), SemanticError);
+  REQUIRE(env.get_exp(Atom("one")) == Expression(1.0));
+}
@@ -1,6 +1,11 @@
 #include "expression.hpp"
 #include "environment.hpp"
 #include "semantic_error.hpp"
+#include "thread_pool.hpp"
+#include "vector_ops.hpp"
+#include "list_store.hpp"
+#include "matrix.hpp"
+#include "cancellation.hpp"
 
 #include <sstream>
 #include <iostream>
@@ -9,6 +14,48 @@
 #include <vector>
 #include <algorithm>
 #include <string>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <cmath>
+#include <iterator>
+
+// the special forms that can also be named as the procedure argument of
+// apply, map and the other higher-order special forms
+static bool is_special_procedure(const std::string & s){
+  return (s == "apply") || (s == "map") || (s == "pmap") || (s == "reduce")
+         || (s == "fold") || (s == "set-property") || (s == "get-property")
+         || (s == "continuous-plot");
+}
+
+// The out-of-line forms of an Expression, tagged by kind
+struct Expression::Representation {
+
+  enum class Kind { Range, Slice, Matrix };
+  Kind kind;
+
+  // A List made by range keeps only its arithmetic sequence, entries
+  // low + (start + i) * step for i < size, none greater than high. Its
+  // tail stays empty until an operation that edits the List calls
+  // materialize()
+  double low = 0.0;
+  double high = 0.0;
+  double step = 0.0;
+  std::size_t start = 0;
+
+  // A List made by rest, append or join is a slice, the entries
+  // [offset, offset + size) of a store shared with other Lists
+  std::shared_ptr<ListStore> store;
+  std::size_t offset = 0;
+
+  // the number of entries of a range or slice
+  std::size_t size = 0;
+
+  // A Matrix keeps its entries in one row-major buffer
+  std::shared_ptr<const Matrix> matrix;
+
+  explicit Representation(Kind k) noexcept : kind(k){}
+};
 
 Expression::Expression(){}
 
@@ -22,9 +69,29 @@ Expression::Expression(const Expression & a){
 
   m_head = a.m_head;
   m_props = a.m_props;
-  for(auto e : a.m_tail){
-    m_tail.push_back(e);
-  }
+  m_graphic = a.m_graphic;
+  m_rep = a.m_rep;
+  m_tail = a.m_tail;
+
+  // keep linked call sites linked, e.g. in copied lambda bodies
+  m_proc = a.m_proc;
+  m_procVersion = a.m_procVersion;
+  m_lambda = a.m_lambda;
+  m_lambdaVersion = a.m_lambdaVersion;
+}
+
+// the head Atom is small and is still copied, everything else is moved
+Expression::Expression(Expression && a) noexcept
+  : m_head(a.m_head),
+    m_tail(std::move(a.m_tail)),
+    m_props(std::move(a.m_props)),
+    m_graphic(a.m_graphic),
+    m_rep(std::move(a.m_rep)),
+    m_proc(a.m_proc),
+    m_procVersion(a.m_procVersion),
+    m_lambda(std::move(a.m_lambda)),
+    m_lambdaVersion(a.m_lambdaVersion)
+{
 }
 
 // List Type constructor
@@ -48,22 +115,41 @@ Expression & Expression::operator=(const Expression & a){
   // prevent self-assignment
   if(this != &a){
     m_head = a.m_head;
-    
-		m_tail.clear();
-    for(auto e : a.m_tail){
-      m_tail.push_back(e);
-    }
-		
-		m_props.clear();
-		for (auto p : a.m_props) {
-			m_props.emplace(p);
-		}
+    m_rep = a.m_rep;
+
+    // copy the entries in one allocation, each exactly once
+    m_tail = a.m_tail;
+    m_props = a.m_props;
+    m_graphic = a.m_graphic;
+
+    m_proc = a.m_proc;
+    m_procVersion = a.m_procVersion;
+    m_lambda = a.m_lambda;
+    m_lambdaVersion = a.m_lambdaVersion;
   }
   
   return *this;
 }
 
 
+Expression & Expression::operator=(Expression && a) noexcept{
+
+  if(this != &a){
+    m_head = a.m_head;
+    m_tail = std::move(a.m_tail);
+    m_props = std::move(a.m_props);
+    m_graphic = a.m_graphic;
+    m_rep = std::move(a.m_rep);
+
+    m_proc = a.m_proc;
+    m_procVersion = a.m_procVersion;
+    m_lambda = std::move(a.m_lambda);
+    m_lambdaVersion = a.m_lambdaVersion;
+  }
+
+  return *this;
+}
+
 Atom & Expression::head(){
   return m_head;
 }
@@ -73,14 +159,17 @@ const Atom & Expression::head() const{
 }
 
 void Expression::append(const Atom & a){
+  materialize();
   m_tail.emplace_back(a);
 }
 
 void Expression::append(const Expression & e){
+  materialize();
 	m_tail.push_back(e);
 }
 
 Expression * Expression::tail(){
+  materialize();
   Expression * ptr = nullptr;
   
   if(m_tail.size() > 0){
@@ -127,16 +216,171 @@ bool Expression::isHeadLambda() const noexcept{
   return ((m_head.isSymbol()) && (m_head.asSymbol() == "lambda"));
 }
 
+bool Expression::isHeadMatrix() const noexcept{
+  return m_rep && (m_rep->kind == Representation::Kind::Matrix);
+}
+
+
+bool Expression::isLazyRange() const noexcept{
+  return m_rep && (m_rep->kind == Representation::Kind::Range);
+}
+
+bool Expression::isListView() const noexcept{
+  return m_rep && (m_rep->kind != Representation::Kind::Matrix);
+}
 
 Expression::List Expression::asList() const noexcept{
   
   List result;
   
-  if (isHeadList()) { result = m_tail; }
+  if (isListView()) {
+    result.reserve(listSize());
+    for(std::size_t i = 0; i < listSize(); i++){
+      result.push_back(listAt(i));
+    }
+  }
+  else if (isHeadList()) { result = m_tail; }
 
   return result;
 }
 
+std::size_t Expression::listSize() const noexcept{
+
+  if (isListView()) { return m_rep->size; }
+  else if (isHeadList()) { return m_tail.size(); }
+
+  return 0;
+}
+
+Expression Expression::listAt(std::size_t i) const noexcept{
+
+  // computing each entry from the start avoids accumulating rounding error
+  if (isLazyRange()) {
+    // the count is settled by stepping, as ranges always were, so the last
+    // entry computed directly may pass high by a rounding error
+    double entry = m_rep->low + (m_rep->start + i) * m_rep->step;
+    return Expression(Atom(std::min(entry, m_rep->high)));
+  }
+  else if (isListView()) {
+    return m_rep->store->at(m_rep->offset + i);
+  }
+
+  return m_tail[i];
+}
+
+Expression Expression::toSlice() const{
+
+  auto rep = std::make_shared<Representation>(Representation::Kind::Slice);
+  rep->store = std::make_shared<ListStore>();
+  rep->store->append(0, asList());
+  rep->size = rep->store->size();
+
+  Expression result = Expression(List());
+  result.m_rep = std::move(rep);
+  return result;
+}
+
+Expression Expression::listRest() const{
+
+  if (!isListView()) {
+    return toSlice().listRest();
+  }
+  else if (m_rep->size == 1) {
+    return Expression(List());
+  }
+
+  // rest of a range is the same sequence one step further along, and rest
+  // of a slice the same store one entry further along
+  auto rep = std::make_shared<Representation>(*m_rep);
+  if (isLazyRange()) { rep->start++; }
+  else { rep->offset++; }
+  rep->size--;
+
+  Expression result = Expression(List());
+  result.m_rep = std::move(rep);
+  return result;
+}
+
+Expression Expression::listAppend(const Expression & entry) const{
+
+  return listJoin(Expression(List{ entry }));
+}
+
+Expression Expression::listJoin(const Expression & other) const{
+
+  List entries = other.asList();
+
+  // an empty List stays an ordinary List until it has entries to share
+  if (listSize() == 0) {
+    return entries.empty() ? Expression(List()) : Expression(entries).toSlice();
+  }
+
+  bool slice = isListView() && !isLazyRange();
+  auto rep = std::make_shared<Representation>(slice ? *m_rep : *toSlice().m_rep);
+
+  // Extend the store in place when this List ends where the store ends,
+  // otherwise another List has appended past it, so copy to a new store
+  if (!rep->store->append(rep->offset + rep->size, entries)) {
+    rep = std::make_shared<Representation>(*toSlice().m_rep);
+    rep->store->append(rep->size, entries);
+  }
+  rep->size += entries.size();
+
+  Expression result = Expression(List());
+  result.m_rep = std::move(rep);
+  return result;
+}
+
+const Matrix * Expression::asMatrix() const noexcept{
+  return isHeadMatrix() ? m_rep->matrix.get() : nullptr;
+}
+
+Expression Expression::makeMatrix(Matrix matrix){
+
+  auto rep = std::make_shared<Representation>(Representation::Kind::Matrix);
+  rep->matrix = std::make_shared<const Matrix>(std::move(matrix));
+
+  Expression result = Expression(Atom("matrix"));
+  result.m_rep = std::move(rep);
+  return result;
+}
+
+Expression Expression::makeRange(double low, double high, double step, std::size_t size){
+
+  Expression result = Expression(List());
+
+  if (size > 0) {
+    auto rep = std::make_shared<Representation>(Representation::Kind::Range);
+    rep->low = low;
+    rep->high = high;
+    rep->step = step;
+    rep->size = size;
+    result.m_rep = std::move(rep);
+  }
+
+  return result;
+}
+
+void Expression::unlink() noexcept{
+
+  m_proc = nullptr;
+  m_procVersion = 0;
+  m_lambda.reset();
+  m_lambdaVersion = 0;
+
+  for(auto & e : m_tail){
+    e.unlink();
+  }
+}
+
+void Expression::materialize(){
+
+  if (isListView()) {
+    m_tail = asList();
+    m_rep.reset();
+  }
+}
+
 Expression::Lambda Expression::asLambda() const noexcept{
   
   Lambda result;
@@ -167,45 +411,171 @@ Expression::String Expression::asString() const noexcept{
 /***********************************************************************
 Property List and Graphic Primitive Methods
 **********************************************************************/
+// The graphic primitive keys, in the order of Expression::GraphicProperty
+static const char * const GRAPHIC_PROPERTY_KEYS[] = {
+  "\"object-name\"", "\"size\"", "\"thickness\"",
+  "\"position\"", "\"text-scale\"", "\"text-rotation\""
+};
+
+// The interned property keys, seeded with the graphic primitive keys
+struct PropertyTable {
+  std::mutex mutex;
+  std::map<Expression::String, Expression::PropertyId> ids;
+
+  PropertyTable(){
+    for(auto key : GRAPHIC_PROPERTY_KEYS){
+      ids.emplace(key, static_cast<Expression::PropertyId>(ids.size()));
+    }
+  }
+};
+
+static PropertyTable & propertyTable(){
+  static PropertyTable table;
+  return table;
+}
+
+Expression::PropertyId Expression::propertyId(const String & key){
+
+  PropertyTable & table = propertyTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+
+  auto result = table.ids.emplace(key, static_cast<PropertyId>(table.ids.size()));
+  return result.first->second;
+}
+
+bool Expression::findPropertyId(const String & key, PropertyId & id) noexcept{
+
+  // the graphic primitive keys are read most, and never need the lock
+  for(PropertyId i = 0; i < sizeof(GRAPHIC_PROPERTY_KEYS) / sizeof(GRAPHIC_PROPERTY_KEYS[0]); i++){
+    if(key == GRAPHIC_PROPERTY_KEYS[i]){
+      id = i;
+      return true;
+    }
+  }
+
+  PropertyTable & table = propertyTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+
+  auto result = table.ids.find(key);
+  if(result == table.ids.end()){
+    return false;
+  }
+  id = result->second;
+  return true;
+}
+
 void Expression::setProperty(const String key, Expression value)
 {
-  // Add/reset (key, value) to this Expression's property list
-  if(this->m_props.find(key) != this->m_props.end()){
-    std::swap(this->m_props.at(key), value);
+  setProperty(propertyId(key), value);
+}
+
+void Expression::setProperty(PropertyId id, Expression value)
+{
+  // Graphic items are inspected through the tail
+  materialize();
+
+  // Classify the graphic primitive once, here, rather than on every query
+  if(id == OBJECT_NAME){
+    m_graphic = GraphicKind::None;
+    if(value.isHeadString()){
+      const String & name = value.m_head.asString();
+      if(name == "\"point\"")     m_graphic = GraphicKind::Point;
+      else if(name == "\"line\"") m_graphic = GraphicKind::Line;
+      else if(name == "\"text\"") m_graphic = GraphicKind::Text;
+      else if(name == "\"point-cloud\"") m_graphic = GraphicKind::PointCloud;
+      else if(name == "\"polyline\"") m_graphic = GraphicKind::Polyline;
+    }
   }
-  else{
-		this->m_props.emplace(key, value);
+
+  // Add/reset (key, value) to this Expression's property list
+  for(auto & prop : m_props){
+    if(prop.first == id){
+      std::swap(prop.second, value);
+      return;
+    }
   }
+  m_props.emplace_back(id, value);
 }
 
 Expression Expression::getProperty(const String key) const noexcept{
 
+  // a key never interned cannot be set, and reading must not intern it
+  PropertyId id;
+  if(!findPropertyId(key, id)){
+    return Expression();
+  }
+  return getProperty(id);
+}
+
+Expression Expression::getProperty(PropertyId id) const noexcept{
+
   // Search this Expression's property list for key
-  auto result = this->m_props.find(key);
-  if(result != this->m_props.end()){
-    return result->second;
+  const Expression * result = findProperty(id);
+  if(result){
+    return *result;
   }
   
   // Default return NONE
   return Expression();
 }
 
-bool Expression::isPointG() const noexcept{
-  
-  if(getProperty("\"object-name\"").m_head.asString() == "\"point\""){
-    if(isHeadList() && (m_tail.size() == 2)){
-      if (m_tail[0].isHeadNumber() && m_tail[1].isHeadNumber()){
-        return true;
-      }
+const Expression * Expression::findProperty(PropertyId id) const noexcept{
+
+  for(auto & prop : m_props){
+    if(prop.first == id){
+      return &prop.second;
     }
   }
-  return false;
+  return nullptr;
+}
+
+Expression::GraphicKind Expression::graphicKind() const noexcept{
+  return m_graphic;
+}
+
+// entry i of a List; read in place from a concrete List, or into scratch
+// from a lazy view (a range or a slice of a shared store)
+static const Expression & entryAt(const Expression & exp, std::size_t i, Expression & scratch){
+
+  if(!exp.isListView()){
+    return exp.tailConstBegin()[i];
+  }
+  scratch = exp.listAt(i);
+  return scratch;
+}
+
+// read a List of two Numbers
+static bool readPair(const Expression & exp, double & x, double & y){
+
+  if(!exp.isHeadList() || (exp.listSize() != 2)){
+    return false;
+  }
+
+  Expression scratch;
+  const Expression & first = entryAt(exp, 0, scratch);
+  if(!first.isHeadNumber()){
+    return false;
+  }
+  x = first.head().asNumber();
+
+  const Expression & second = entryAt(exp, 1, scratch);
+  if(!second.isHeadNumber()){
+    return false;
+  }
+  y = second.head().asNumber();
+  return true;
+}
+
+bool Expression::isPointG() const noexcept{
+
+  double x, y;
+  return (m_graphic == GraphicKind::Point) && readPair(*this, x, y);
 }
 
 bool Expression::isLineG() const noexcept{
   
-  if(getProperty("\"object-name\"").m_head.asString() == "\"line\""){
-    if(isHeadList() && (m_tail.size() == 2)){
+  if(m_graphic == GraphicKind::Line){
+    if(isHeadList() && (listSize() == 2)){
       //if( m_tail[0].isPointG() && m_tail[1].isPointG() ){
         return true;
       //}
@@ -216,9 +586,164 @@ bool Expression::isLineG() const noexcept{
 
 bool Expression::isTextG() const noexcept{
   
-  return ( isHeadString() && (getProperty("\"object-name\"").m_head.asString() == "\"text\"") );
+  return ( isHeadString() && (m_graphic == GraphicKind::Text) );
 }
 
+// a List of an even number of Numbers, the coordinates of a batch of points
+static bool isCoordinateList(const Expression & exp, std::size_t minPoints){
+
+  if(!exp.isHeadList()){
+    return false;
+  }
+
+  std::size_t n = exp.listSize();
+  if( (n % 2 != 0) || (n < 2 * minPoints) ){
+    return false;
+  }
+
+  Expression scratch;
+  for(std::size_t i = 0; i < n; i++){
+    if(!entryAt(exp, i, scratch).isHeadNumber()) return false;
+  }
+  return true;
+}
+
+// split the coordinates of a batch of points into x and y arrays
+static void readCoordinates(const Expression & exp, std::vector<double> & xs, std::vector<double> & ys){
+
+  std::size_t n = exp.listSize() / 2;
+  xs.resize(n);
+  ys.resize(n);
+
+  Expression scratch;
+  for(std::size_t i = 0; i < n; i++){
+    xs[i] = entryAt(exp, 2 * i, scratch).head().asNumber();
+    ys[i] = entryAt(exp, 2 * i + 1, scratch).head().asNumber();
+  }
+}
+
+bool Expression::isPointCloudG() const noexcept{
+
+  return (m_graphic == GraphicKind::PointCloud) && isCoordinateList(*this, 1);
+}
+
+bool Expression::isPolylineG() const noexcept{
+
+  return (m_graphic == GraphicKind::Polyline) && isCoordinateList(*this, 2);
+}
+
+bool Expression::asPointCloudG(PointCloudG & cloud) const noexcept{
+
+  if(!isPointCloudG()){
+    return false;
+  }
+
+  cloud = PointCloudG();
+  readCoordinates(*this, cloud.xs, cloud.ys);
+
+  // If "size" is present in the property list, it must be a positive Number
+  if(const Expression * size = findProperty(SIZE)){
+    if(!size->isHeadNumber() || (size->m_head.asNumber() <= 0)){
+      return false;
+    }
+    cloud.size = size->m_head.asNumber();
+  }
+  return true;
+}
+
+bool Expression::asPolylineG(PolylineG & line) const noexcept{
+
+  if(!isPolylineG()){
+    return false;
+  }
+
+  line = PolylineG();
+  readCoordinates(*this, line.xs, line.ys);
+
+  // If "thickness" is present in the property list, it must be a non-negative Number
+  if(const Expression * thickness = findProperty(THICKNESS)){
+    if(!thickness->isHeadNumber() || (thickness->m_head.asNumber() < 0)){
+      return false;
+    }
+    line.thickness = thickness->m_head.asNumber();
+  }
+  return true;
+}
+
+bool Expression::asPointG(PointG & point) const noexcept{
+
+  if(!isPointG()){
+    return false;
+  }
+
+  point = PointG();
+  readPair(*this, point.x, point.y);
+
+  // If "size" is present in the property list, it must be a positive Number
+  if(const Expression * size = findProperty(SIZE)){
+    if(!size->isHeadNumber() || (size->m_head.asNumber() <= 0)){
+      return false;
+    }
+    point.size = size->m_head.asNumber();
+  }
+  return true;
+}
+
+bool Expression::asLineG(LineG & line) const noexcept{
+
+  if(!isLineG()){
+    return false;
+  }
+
+  line = LineG();
+  Expression scratch;
+  if(!readPair(entryAt(*this, 0, scratch), line.x1, line.y1)){
+    return false;
+  }
+  if(!readPair(entryAt(*this, 1, scratch), line.x2, line.y2)){
+    return false;
+  }
+
+  // If "thickness" is present in the property list, it must be a non-negative Number
+  if(const Expression * thickness = findProperty(THICKNESS)){
+    if(!thickness->isHeadNumber() || (thickness->m_head.asNumber() < 0)){
+      return false;
+    }
+    line.thickness = thickness->m_head.asNumber();
+  }
+  return true;
+}
+
+bool Expression::asTextG(TextG & text) const noexcept{
+
+  if(!isTextG()){
+    return false;
+  }
+
+  text = TextG();
+  text.text = asString();
+
+  // If "position" is present in the property list, it must be a Point
+  if(const Expression * position = findProperty(POSITION)){
+    if(!position->isPointG()){
+      return false;
+    }
+    readPair(*position, text.x, text.y);
+  }
+
+  if(const Expression * scale = findProperty(TEXT_SCALE)){
+    if(scale->isHeadNumber() && (scale->m_head.asNumber() > 0)){
+      text.scale = scale->m_head.asNumber();
+    }
+  }
+
+  if(const Expression * rotation = findProperty(TEXT_ROTATION)){
+    if(rotation->isHeadNumber()){
+      text.rotation = rotation->m_head.asNumber();
+    }
+  }
+  return true;
+}
 
 /*
 std::vector<double> Expression::getDataExtrema(const Expression::List & dataList){
@@ -289,87 +814,142 @@ std::vector<double> Expression::getDataExtrema(const Expression::List & dataList
 }
 */
 
-std::vector<Expression::Point> parseData(const Expression::List & dataList, LayoutParams & params){
-	
-	std::vector<Expression::Point> results;
-	
-	// Initialize extrema point data
-	double xMax = 0.0; double yMax = 0.0;
-	double xMin = 0.0; double yMin = 0.0;
-	
-	// Check first two points first
-	Expression p1 = dataList[0];
-	Expression p2 = dataList[1];
+// Read an (x y) data entry, false unless it is a List of two finite Numbers;
+// an infinite or NaN coordinate has no place on the axes
+static bool readPoint(const Expression & entry, double & x, double & y){
 
-	// Each Data entry must a List of 2 Numbers or error
-	if ( p1.isHeadList() && (p1.asList().size() == 2)
-		&& p2.isHeadList() && (p2.asList().size() == 2) )
-	{
-		Expression::List temp1 = p1.asList();
-		Expression::List temp2 = p2.asList();
+	if (!entry.isHeadList() || (entry.listSize() != 2)) {
+		return false;
+	}
 
-		if ( temp1[0].isHeadNumber() && temp1[1].isHeadNumber()
-			&& temp2[0].isHeadNumber() && temp2[1].isHeadNumber() )
-		{
-			double x1 = temp1[0].head().asNumber();
-			double y1 = temp1[1].head().asNumber();
-			
-			double x2 = temp2[0].head().asNumber();
-			double y2 = temp2[1].head().asNumber();
+	if (entry.isListView()) {
+		return readPoint(Expression(entry.asList()), x, y);
+	}
 
-			// Assign initial data bounding box values for comparison
-			xMax = std::max(x1, x2);	yMax = std::max(y1, y2);
-			xMin = std::min(x1, x2);	yMin = std::min(y1, y2);
-		}
-		else { throw SemanticError("Error: invalid Data points"); }
+	Expression::ConstIteratorType it = entry.tailConstBegin();
+	if (!it[0].isHeadNumber() || !it[1].isHeadNumber()) {
+		return false;
 	}
-	else { throw SemanticError("Error: invalid Data points"); }
 
+	x = it[0].head().asNumber();
+	y = it[1].head().asNumber();
+	return std::isfinite(x) && std::isfinite(y);
+}
 
-	// Can now safely check any and all remaining points in data list
-	for (auto & exp : dataList) {
+/* Validate the data entries and copy their coordinates into separate x and
+ * y arrays in a single pass, then find the data extents with vectorized
+ * reductions over those arrays.
+ */
+void parseData(const Expression & data, PackedArray & xs, PackedArray & ys, LayoutParams & params){
+	
+	// Must be at least 2 points to process
+	std::size_t n = data.listSize();
+	if (n < 2) {
+		throw SemanticError("Error: invalid Data points");
+	}
+
+	xs.re.resize(n);
+	ys.re.resize(n);
+
+	// Read the entries of a plain List in place, and a List view's by value
+	const Expression * entries = data.isListView() ? nullptr : &*data.tailConstBegin();
+
+	for (std::size_t i = 0; i < n; i++) {
 		// Each Data entry must a List of 2 Numbers or error
-		if (exp.isHeadList() && (exp.asList().size() == 2)) {
-			if (exp.asList()[0].isHeadNumber() && exp.asList()[1].isHeadNumber()) {
-				/*--- Keep track of the max and min x and y values ---*/
-				double thisX = exp.asList()[0].head().asNumber();
-				double thisY = exp.asList()[1].head().asNumber();
-				
-				xMax = std::max(xMax, thisX);		yMax = std::max(yMax, thisY);
-				xMin = std::min(xMin, thisX);		yMin = std::min(yMin, thisY);
-				
-				Expression::Point point = std::make_pair(thisX, thisY);
-				
-				results.push_back(point);
-			}
-			else { throw SemanticError("Error: found invalid Data point"); }
+		bool valid = entries ? readPoint(entries[i], xs.re[i], ys.re[i])
+		                     : readPoint(data.listAt(i), xs.re[i], ys.re[i]);
+		if (!valid) {
+			throw SemanticError((i < 2) ? "Error: invalid Data points" : "Error: found invalid Data point");
 		}
-		else { throw SemanticError("Error: found invalid Data point"); }
 	}
 	
-	// Assign properties
-	params.xMax = xMax;		params.yMax = yMax;
-	params.xMin = xMin;		params.yMin = yMin;
-
-	return results;
+	/*--- Keep track of the max and min x and y values ---*/
+	Expression extreme;
+	packedReduce(xs, Reduction::Min, extreme);	params.xMin = extreme.head().asNumber();
+	packedReduce(xs, Reduction::Max, extreme);	params.xMax = extreme.head().asNumber();
+	packedReduce(ys, Reduction::Min, extreme);	params.yMin = extreme.head().asNumber();
+	packedReduce(ys, Reduction::Max, extreme);	params.yMax = extreme.head().asNumber();
 };
 
+Expression Expression::makePointG(const Expression & x, const Expression & y){
+
+	// Create a Point graphic item
+	Expression pointItem = Expression(List{ x, y });
+
+	// Set properties
+	pointItem.setProperty(Expression::OBJECT_NAME, Expression(Atom("\"point\"")));
+
+	return pointItem;
+}
+
+Expression Expression::makeLineG(const Expression & p1, const Expression & p2){
+
+	// Create a Line graphic item
+	Expression lineItem = Expression(List{ p1, p2 });
+
+	// Set properties
+	lineItem.setProperty(Expression::OBJECT_NAME, Expression(Atom("\"line\"")));
+
+	return lineItem;
+}
+
+Expression Expression::makeTextG(const Expression & text){
+
+	// Copy the text item, keeping any properties already set
+	Expression textItem = text;
+
+	// Set properties
+	textItem.setProperty(Expression::OBJECT_NAME, Expression(Atom("\"text\"")));
+
+	return textItem;
+}
+
+// a List of the Numbers x1 y1 x2 y2 ..., the coordinates of a batch of points
+static Expression::List interleave(const std::vector<double> & xs, const std::vector<double> & ys){
+
+	Expression::List coordinates;
+	coordinates.reserve(2 * xs.size());
+	for (std::size_t i = 0; i < xs.size(); i++) {
+		coordinates.push_back(Expression(Atom(xs[i])));
+		coordinates.push_back(Expression(Atom(ys[i])));
+	}
+	return coordinates;
+}
+
+Expression Expression::makePointCloudG(const std::vector<double> & xs, const std::vector<double> & ys){
+
+	// Create a Point Cloud graphic item
+	Expression cloudItem = Expression(interleave(xs, ys));
+
+	// Set properties
+	cloudItem.setProperty(Expression::OBJECT_NAME, Expression(Atom("\"point-cloud\"")));
+
+	return cloudItem;
+}
+
+Expression Expression::makePolylineG(const std::vector<double> & xs, const std::vector<double> & ys){
+
+	// Create a Polyline graphic item
+	Expression lineItem = Expression(interleave(xs, ys));
+
+	// Set properties
+	lineItem.setProperty(Expression::OBJECT_NAME, Expression(Atom("\"polyline\"")));
+
+	return lineItem;
+}
+
 Expression makePoint(double x, double y, double size){
 	
 	// Create Number Expression coordinates
 	Expression xVal = Expression(Atom(x));
 	Expression yVal = Expression(Atom(y));
-	Expression::List values = { xVal, yVal };
 
 	// Create a Point graphic item
-	Expression pointItem = Expression(values);
+	Expression pointItem = Expression::makePointG(xVal, yVal);
 	
 	// Set properties
-	Expression name = Expression(Atom("\"point\""));
-	pointItem.setProperty("\"object-name\"", name);
-
 	Expression s = Expression(Atom(size));
-	pointItem.setProperty("\"size\"", s);
+	pointItem.setProperty(Expression::SIZE, s);
 
 	return pointItem;
 };
@@ -379,17 +959,35 @@ Expression makeLine(double x1, double y1, double x2, double y2, double thicc){
 	// Create Point Expression items
 	Expression p1 = makePoint(x1, y1, 1.0);
 	Expression p2 = makePoint(x2, y2, 1.0);
-	Expression::List values = { p1, p2 };
 
-	// Create a Line graphic item
-	Expression lineItem = Expression(values);
+	// Create a Line graphic item
+	Expression lineItem = Expression::makeLineG(p1, p2);
+
+	// Set properties
+	Expression t = Expression(Atom(thicc));
+	lineItem.setProperty(Expression::THICKNESS, t);
+
+	return lineItem;
+};
+
+Expression makePointCloud(const std::vector<double> & xs, const std::vector<double> & ys, double size){
+
+	// Create a Point Cloud graphic item
+	Expression cloudItem = Expression::makePointCloudG(xs, ys);
+
+	// Set properties, shared by every point
+	cloudItem.setProperty(Expression::SIZE, Expression(Atom(size)));
 
-	// Set properties
-	Expression name = Expression(Atom("\"line\""));
-	lineItem.setProperty("\"object-name\"", name);
+	return cloudItem;
+};
 
-	Expression t = Expression(Atom(thicc));
-	lineItem.setProperty("\"thickness\"", t);
+Expression makePolyline(const std::vector<double> & xs, const std::vector<double> & ys, double thicc){
+
+	// Create a Polyline graphic item
+	Expression lineItem = Expression::makePolylineG(xs, ys);
+
+	// Set properties, shared by every segment
+	lineItem.setProperty(Expression::THICKNESS, Expression(Atom(thicc)));
 
 	return lineItem;
 };
@@ -461,6 +1059,84 @@ double getTextScale(const Expression::List & options){
 	return txtScale;
 };
 
+double getPointBudget(const Expression::List & options, const LayoutParams & params){
+
+	double budget = params.budget;	// Most data points to draw
+
+	// A larger budget than any data can reach draws every point; capped so it
+	// converts to a std::size_t exactly
+	const double MAX_BUDGET = 9007199254740992.0; // 2^53
+
+	for (auto & option : options) {
+		// Shape of each Option entry is already checked by getTextScale
+		std::string name = option.asList()[0].asString();
+		Expression value = option.asList()[1];
+
+		if (name == "point-budget") {
+			// Must be a whole Number of at least 2, room for one bucket's extremes
+			if (value.isHeadNumber() && (value.head().asNumber() >= 2.0)
+				&& (value.head().asNumber() == std::floor(value.head().asNumber())) ) {
+				budget = std::min(value.head().asNumber(), MAX_BUDGET);
+			}
+			else {
+				throw SemanticError("Error: invalid Option, point-budget must be a whole Number of at least 2");
+			}
+		}
+	}
+	return budget;
+};
+
+/* Decimate the data points to at most budget points that look the same when
+ * drawn: the x range is split into budget / 2 equal buckets, and only the
+ * points with the smallest and largest y of each bucket are kept, in their
+ * original order, so every peak and trough of the data survives. Returns the
+ * number of points dropped.
+ */
+std::size_t decimate(PackedArray & xs, PackedArray & ys, const LayoutParams & params, std::size_t budget){
+
+	std::size_t n = xs.size();
+	std::size_t buckets = budget / 2;
+	double width = params.xMax - params.xMin;
+
+	// the indices of the lowest and highest point seen in each bucket
+	const std::size_t none = n;
+	std::vector<std::size_t> lowest(buckets, none), highest(buckets, none);
+
+	for (std::size_t i = 0; i < n; i++) {
+		double t = (width > 0.0) ? (xs.re[i] - params.xMin) / width : 0.0;
+		std::size_t b = std::min(static_cast<std::size_t>(t * buckets), buckets - 1);
+
+		if ( (lowest[b] == none) || (ys.re[i] < ys.re[lowest[b]]) ) {
+			lowest[b] = i;
+		}
+		if ( (highest[b] == none) || (ys.re[i] > ys.re[highest[b]]) ) {
+			highest[b] = i;
+		}
+	}
+
+	std::vector<bool> keep(n, false);
+	for (std::size_t b = 0; b < buckets; b++) {
+		if (lowest[b] != none) {
+			keep[lowest[b]] = true;
+			keep[highest[b]] = true;
+		}
+	}
+
+	// compact the kept points to the front of the arrays
+	std::size_t kept = 0;
+	for (std::size_t i = 0; i < n; i++) {
+		if (keep[i]) {
+			xs.re[kept] = xs.re[i];
+			ys.re[kept] = ys.re[i];
+			kept++;
+		}
+	}
+	xs.re.resize(kept);
+	ys.re.resize(kept);
+
+	return n - kept;
+};
+
 Expression makeText(const Expression::String & text, double x, double y, double s, double rotate){
 
 	// Need to add '\"' to make text a String literal
@@ -469,30 +1145,25 @@ Expression makeText(const Expression::String & text, double x, double y, double
 	outStream << "\"" << text << "\"";
 	std::string strHack = outStream.str();
 
-	Expression result = Expression(Atom(strHack));
+	Expression result = Expression::makeTextG(Expression(Atom(strHack)));
 
 	// Convert input to radians
 	double deg = rotate;
 	double rad = deg * (std::atan2(0.0,-1.0) / 180.0);
 	
 	Expression rotation = Expression(Atom(rad));
-	Expression name = Expression(Atom("\"text\""));
 	Expression scale = Expression(Atom(s));
 
-	result.setProperty("\"text-rotation\"", rotation);
-	result.setProperty("\"object-name\"", name);
-	result.setProperty("\"text-scale\"", scale);
+	result.setProperty(Expression::TEXT_ROTATION, rotation);
+	result.setProperty(Expression::TEXT_SCALE, scale);
 
 	// Make Text item's center-point
 	Expression xVal = Expression(Atom(x));
 	Expression yVal = Expression(Atom(y));
 
-	Expression::List data = { xVal, yVal };
-	Expression pointItem = Expression(data);
-
-	pointItem.setProperty("\"object-name\"", Expression(Atom("\"point\"")));
+	Expression pointItem = Expression::makePointG(xVal, yVal);
 
-	result.setProperty("\"position\"", pointItem);
+	result.setProperty(Expression::POSITION, pointItem);
 
 	return result;
 };
@@ -580,16 +1251,13 @@ Expression::List makeTickLabels(const LayoutParams & oldParams, const LayoutPara
 };
 
 
-Expression::List Expression::makeDiscretePlot(const List & data, const List & options){
-
-	List results;
-	LayoutParams params;
+/* Scale the data extents in params into the N x N plot box, filling in the
+ * box limits and centers of outParams, and return the box border and axis
+ * Lines. Shared by discrete-plot and continuous-plot.
+ */
+Expression::List makePlotBox(const LayoutParams & params, LayoutParams & outParams,
+                             double & scaleX, double & scaleY){
 
-	/*--- Read and Process each Data List Entry ---*/
-	std::vector<Point> points = parseData(data, params);
-	
-	LayoutParams outParams;
-	
 	/*--- Calculate Scaled Values ---*/
 	double dataWidth = std::abs(params.xMax - params.xMin);
 	double dataHeight = std::abs(params.yMax - params.yMin);
@@ -600,8 +1268,8 @@ Expression::List Expression::makeDiscretePlot(const List & data, const List & op
 	}
 	
 	/*---  Scaling Factor for (N x N) Box ---*/
-	double scaleX =  (params.N / dataWidth);
-	double scaleY =  (params.N / dataHeight);
+	scaleX =  (params.N / dataWidth);
+	scaleY =  (params.N / dataHeight);
 	
 	///////////////////////////////////////////////////////////////////////////////
 	// Design Note:
@@ -628,43 +1296,103 @@ Expression::List Expression::makeDiscretePlot(const List & data, const List & op
 	outParams.yMin = scaleY * params.yMin;
 	outParams.yMax = scaleY * params.yMax;
 	
-	List box = makeBoundBox(outParams);
-	for (auto & item : box) {
-		results.push_back(item);
-	}
+	Expression::List box = makeBoundBox(outParams);
 
 	// Bounding box centers for label text
 	outParams.xMid = outParams.xMin + (boxWidth / 2);
 	outParams.yMid = outParams.yMin + (boxHeight / 2);
 
+	return box;
+};
+
+
+Expression::List Expression::makeDiscretePlot(const Expression & data, const List & options, std::size_t & dropped){
+
+	List results;
+	LayoutParams params;
+
+	/*--- Read and Process each Data List Entry ---*/
+	PackedArray xs, ys;
+	parseData(data, xs, ys, params);
+
+	/*--- Decimate Data Too Dense to Draw ---*/
+	getTextScale(options); // Checks the shape of every Option
+	std::size_t budget = static_cast<std::size_t>(getPointBudget(options, params));
+	dropped = 0;
+	if (xs.size() > budget) {
+		dropped = decimate(xs, ys, params, budget);
+	}
+	
+	LayoutParams outParams;
+	double scaleX, scaleY;
+
+	/*--- Scale the Data into the Bounding Box ---*/
+	List box = makePlotBox(params, outParams, scaleX, scaleY);
+
+	// y is negated here, rather than during point creation as elsewhere
+	PackedArray scale;
+	scale.broadcast = true;
+	scale.re.assign(1, scaleX);
+	packedMul(xs, scale);
+	scale.re.assign(1, -scaleY);
+	packedMul(ys, scale);
+
+	// Check which direction to draw extension lines
+	double stemEnd;
+	if(outParams.xAxis){ // (yMin < 0.0 < yMax)
+		// Draw line from point to axis
+		stemEnd = 0.0;
+	}
+	else if(outParams.yMax <= 0.0){
+		// Draw line from point to top box edge
+		stemEnd = -outParams.yMax;
+	}
+	else{
+		// Draw line from point to bottom box edge
+		stemEnd = -outParams.yMin;
+	}
 
 	/*--- Create Stem Plot Points ---*/
-	for (auto & point : points) {
-		
-		// Scale each old point to make new point
-		double thisX =  (scaleX * point.first);
-		double thisY =  (scaleY * point.second); // Negate during final point creation
-		
-		// Create and add a Point graphic item to result, along with extension line
-		Expression pointItem = makePoint(thisX, -thisY, outParams.P);
-		Expression stemItem;
-		
-		// Check which direction to draw extension lines
-		if(outParams.xAxis){ // (yMin < 0.0 < yMax)
-			// Draw line from point to axis
-			stemItem = makeLine(thisX, -thisY, thisX, 0.0, 0.0);
-		}
-		else if(outParams.yMax <= 0.0){
-			// Draw line from point to top box edge
-			stemItem = makeLine(thisX, -thisY, thisX, -outParams.yMax, 0.0);
+	std::size_t n = xs.size();
+
+	if (n > params.batch) {
+		// Draw all the points as one Point Cloud, and all the stems as one
+		// Polyline that runs along the stem base between stems. The base is
+		// the x axis or a box edge, so those runs are already drawn
+		results = box;
+		results.push_back(makePointCloud(xs.re, ys.re, outParams.P));
+
+		std::vector<double> stemXs(3 * n), stemYs(3 * n);
+		for (std::size_t i = 0; i < n; i++) {
+			stemXs[3 * i] = stemXs[3 * i + 1] = stemXs[3 * i + 2] = xs.re[i];
+			stemYs[3 * i] = stemEnd;
+			stemYs[3 * i + 1] = ys.re[i];
+			stemYs[3 * i + 2] = stemEnd;
 		}
-		else if(outParams.yMin >= 0.0){
-			// Draw line from point to bottom box edge
-			stemItem = makeLine(thisX, -thisY, thisX, -outParams.yMin, 0.0);
+		results.push_back(makePolyline(stemXs, stemYs, 0.0));
+	}
+	else {
+		// Every Point and stem Line is a copy of one template with its coordinates
+		// filled in, written straight into place
+		std::size_t first = box.size();
+		results.resize(first + 2 * n);
+		std::move(box.begin(), box.end(), results.begin());
+
+		const Expression pointTemplate = makePoint(0.0, 0.0, outParams.P);
+		const Expression stemTemplate = makeLine(0.0, 0.0, 0.0, stemEnd, 0.0);
+
+		for (std::size_t i = 0; i < n; i++) {
+			Expression & pointItem = results[first + 2 * i];
+			pointItem = pointTemplate;
+			pointItem.m_tail[0].m_head = Atom(xs.re[i]);
+			pointItem.m_tail[1].m_head = Atom(ys.re[i]);
+
+			Expression & stemItem = results[first + 2 * i + 1];
+			stemItem = stemTemplate;
+			stemItem.m_tail[0].m_tail[0].m_head = Atom(xs.re[i]);
+			stemItem.m_tail[0].m_tail[1].m_head = Atom(ys.re[i]);
+			stemItem.m_tail[1].m_tail[0].m_head = Atom(xs.re[i]);
 		}
-		
-		results.push_back(pointItem);
-		results.push_back(stemItem);
 	}
 
 	/*--- Get Text Scaling Factor ---*/
@@ -686,6 +1414,85 @@ Expression::List Expression::makeDiscretePlot(const List & data, const List & op
 }
 
 
+Expression::List Expression::makeContinuousPlot(const std::vector<Point> & samples, const List & options){
+
+	List results;
+	LayoutParams params;
+
+	/*--- Find the Extents of the Finite Samples ---*/
+	bool any = false;
+	for (auto & sample : samples) {
+		if (!std::isfinite(sample.second)) continue;
+
+		if (!any) {
+			params.xMin = params.xMax = sample.first;
+			params.yMin = params.yMax = sample.second;
+			any = true;
+		}
+		params.xMin = std::min(params.xMin, sample.first);	params.xMax = std::max(params.xMax, sample.first);
+		params.yMin = std::min(params.yMin, sample.second);	params.yMax = std::max(params.yMax, sample.second);
+	}
+	if (!any) {
+		throw SemanticError("Error: invalid input Data");
+	}
+
+	LayoutParams outParams;
+	double scaleX, scaleY;
+
+	/*--- Scale the Data into the Bounding Box ---*/
+	List box = makePlotBox(params, outParams, scaleX, scaleY);
+	for (auto & item : box) {
+		results.push_back(item);
+	}
+
+	/*--- Join Consecutive Samples with Lines ---*/
+	// the curve is broken wherever the function is not finite, e.g. at a pole
+	if (samples.size() > params.batch) {
+		// Draw each unbroken run of samples as one Polyline
+		std::vector<double> runXs, runYs;
+		for (std::size_t i = 0; i <= samples.size(); i++) {
+			if ( (i < samples.size()) && std::isfinite(samples[i].second) ) {
+				runXs.push_back(scaleX * samples[i].first);
+				runYs.push_back(-(scaleY * samples[i].second));
+				continue;
+			}
+			if (runXs.size() > 1) {
+				results.push_back(makePolyline(runXs, runYs, 0.0));
+			}
+			runXs.clear();
+			runYs.clear();
+		}
+	}
+	else {
+		for (std::size_t i = 1; i < samples.size(); i++) {
+			const Point & a = samples[i - 1];
+			const Point & b = samples[i];
+			if (!std::isfinite(a.second) || !std::isfinite(b.second)) continue;
+
+			results.push_back(makeLine(scaleX * a.first, -(scaleY * a.second),
+			                           scaleX * b.first, -(scaleY * b.second), 0.0));
+		}
+	}
+
+	/*--- Get Text Scaling Factor ---*/
+	outParams.txtScale = getTextScale(options); // Scaling factor for all Text
+
+	/*--- Use Options List to Make Text Labels ---*/
+	List optionsResult = processOptions(options, outParams);
+	for (auto & item : optionsResult) {
+		results.push_back(item);
+	}
+
+	/*--- Make the Tick Mark Text Labels ---*/
+	List labels = makeTickLabels(params, outParams);
+	for (auto & item : labels) {
+		results.push_back(item);
+	}
+
+	return results;
+}
+
+
 /***********************************************************************
 Private Methods
 **********************************************************************/
@@ -696,21 +1503,46 @@ Expression Expression::apply(const Atom & op, const List & args, const Environme
   if(!op.isSymbol()){
     throw SemanticError("Error during evaluation: procedure name not symbol");
   }
+
+  // The inline cache only describes this node's own head symbol
+  bool callSite = (&op == &m_head);
+
+  // Skip the lookup if this call site was already linked
+  if(callSite && (m_procVersion == env.proc_version())){
+    return m_proc(args);
+  }
+  if(callSite && m_lambda && (m_lambdaVersion == env.exp_version())){
+    // hold a reference in case a nested call re-links this site
+    std::shared_ptr<Expression> function = m_lambda;
+    return call_lambda(*function, args, env);
+  }
   
   // Must map to a built-in or user-defined proc
   if(env.is_proc(op)){
     // map from symbol to proc
     Procedure proc = env.get_proc(op);
 
+    // link the call site to the built-in once
+    if(callSite){
+      m_proc = proc;
+      m_procVersion = env.proc_version();
+    }
+
     // call proc with args
     return proc(args);
   }
   else if(env.is_anon_proc(op)){
-    // Get the function the symbol maps to
-		Expression mappedExp = env.get_exp(op);
+    // Get the function the symbol maps to, shared with the Environment
+		std::shared_ptr<Expression> mappedExp = env.get_lambda(op);
+
+    // remember the function until the lambda bindings change
+    if(callSite){
+      m_lambda = mappedExp;
+      m_lambdaVersion = env.exp_version();
+    }
 
 		// Evaluate function with args
-		return call_lambda(mappedExp, args, env);
+		return call_lambda(*mappedExp, args, env);
   }
   else{
     throw SemanticError("Error during evaluation: symbol does not name a procedure");
@@ -780,8 +1612,7 @@ Expression Expression::handle_define(Environment & env){
     throw SemanticError("Error during evaluation: attempt to redefine a special-form");
   }
   
-  if( (env.is_proc(m_head)) || (s == "apply") || (s == "map")
-      || (s == "set-property") || (s == "get-property") )
+  if( (env.is_proc(m_head)) || is_special_procedure(s) )
   {
     throw SemanticError("Error during evaluation: attempt to redefine a built-in procedure");
   }
@@ -866,8 +1697,7 @@ Expression Expression::handle_apply(Environment & env){
   std::string s = proc.asSymbol();
 
   // tail[0] must be a built-in or user-defined procedure
-  if( !( env.is_proc(proc) || env.is_anon_proc(proc) || (s == "apply") || (s == "map")
-				|| (s == "set-property") || (s == "get-property") ) )
+  if( !( env.is_proc(proc) || env.is_anon_proc(proc) || is_special_procedure(s) ) )
   {
     throw SemanticError("Error during evaluation: first argument in call to apply is not a Procedure");
   }
@@ -877,16 +1707,9 @@ Expression Expression::handle_apply(Environment & env){
 	if(!argsEvaled.isHeadList()){
     throw SemanticError("Error during evaluation: second argument in call to apply is not a List");
   }
-  
-  // Extract second piece of apply function
-  List argsList = argsEvaled.asList();
-  
-  // Set up restructured AST in form: (<procedure> <argument> <argument> ...)
-  Expression result = Expression(proc);
-  result.m_tail = argsList;
-  
-  // Evaluate result of applied procedure
-  return result.eval(env);
+
+  // Call the procedure directly on the argument values
+  return invoke(proc, argsEvaled.asList(), env);
 }
 
 /*
@@ -894,8 +1717,13 @@ Expression Expression::handle_apply(Environment & env){
  * The built-in binary procedure map is similar to apply, but treats each
  * entry of the list as a separate argument to the procedure, returning a
  * list of the same size of results.
+ *
+ * (pmap <procedure> <list>)
+ * pmap gives the same results and errors as map, but evaluates the entries
+ * in parallel on the thread pool when the procedure is a built-in or a
+ * user-defined lambda.
  */
-Expression Expression::handle_map(Environment & env){
+Expression Expression::handle_map(Environment & env, bool parallel){
   
   // tail must have 2 arguments or error
   if(m_tail.size() != 2){
@@ -912,8 +1740,7 @@ Expression Expression::handle_map(Environment & env){
   std::string s = sym.asSymbol();
 
   // tail[0] must be a built-in or user-defined procedure
-  if( !(env.is_proc(sym) || env.is_anon_proc(sym) || (s == "apply") || (s == "map")
-      || (s == "set-property") || (s == "get-property")) )
+  if( !(env.is_proc(sym) || env.is_anon_proc(sym) || is_special_procedure(s)) )
   {
     throw SemanticError("Error during evaluation: first argument to map is not a Procedure");
   }
@@ -923,32 +1750,343 @@ Expression Expression::handle_map(Environment & env){
 	if(!argsEvaled.isHeadList()){
     throw SemanticError("Error during evaluation: second argument to map is not a List");
   }
-  
-  // Extract second piece of map function
-  List argsIn = argsEvaled.asList();
 
-  // Set up restructured AST in form: (list <expression> <expression> ...)
-  Expression results(Atom("list"));
+  // Resolve the procedure once for the whole List
+  Procedure proc = nullptr;
+  Expression lambda;
+  if(env.is_proc(sym)){
+    proc = env.get_proc(sym);
+  }
+  else if(env.is_anon_proc(sym)){
+    lambda = env.get_exp(sym);
+  }
+
+  // Nested pmaps, e.g. one inside a lambda being mapped, run inline on the
+  // worker they are called from, see ThreadPool::parallel_for
+  std::size_t n = argsEvaled.listSize();
+  if(parallel && (proc || lambda.isHeadLambda()) && (n > 1)){
+    return parallel_map(proc, lambda, argsEvaled, env);
+  }
+
+  List results;
+  results.reserve(argsEvaled.listSize());
+
+  // Apply the Procedure to each entry in the argument List, reading the
+  // entries one at a time so a lazy range is never materialized
+  List argument(1);
+  for(std::size_t i = 0; i < argsEvaled.listSize(); i++){
+    // built-ins are called without going through eval
+    CancellationToken::check();
+    argument[0] = argsEvaled.listAt(i);
+
+    if(proc){
+      results.push_back(proc(argument));
+    }
+    else if(lambda.isHeadLambda()){
+      results.push_back(call_lambda(lambda, argument, env));
+    }
+    else{
+      results.push_back(invoke(sym, argument, env));
+    }
+  }
+
+  return Expression(results);
+}
+
+// Evaluate a map on the thread pool. The Environment is only read, and each
+// chunk of entries calls its own unlinked copy of the lambda, in a fork of
+// the Environment with its own copies of the bound lambdas, so the inline
+// caches it fills in are never shared between workers. If entries fail, the
+// error from the lowest index is rethrown, exactly as a sequential map would.
+Expression Expression::parallel_map(Procedure proc, const Expression & lambda,
+                                    const Expression & argsEvaled, const Environment & env)
+{
+  std::size_t n = argsEvaled.listSize();
+  List results(n);
+
+  std::mutex errorMutex;
+  std::atomic<std::size_t> errorIndex(n);
+  std::exception_ptr error;
+
+  // the workers watch the token of the evaluation that started the map
+  const CancellationToken * token = CancellationToken::current();
+
+  ThreadPool::instance().parallel_for(n, [&](std::size_t begin, std::size_t end){
+
+    CancellationScope scope(token);
+
+    Expression function = lambda;
+    function.unlink();
+
+    Environment local(env);
+    local.isolate();
+
+    List argument(1);
+    for(std::size_t i = begin; i < end; i++){
+      // entries after an earlier failure cannot change the outcome
+      if(i > errorIndex) break;
+
+      try{
+        CancellationToken::check();
+        argument[0] = argsEvaled.listAt(i);
+        results[i] = proc ? proc(argument) : call_lambda(function, argument, local);
+      }
+      catch(...){
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if(i < errorIndex){
+          errorIndex = i;
+          error = std::current_exception();
+        }
+        break;
+      }
+    }
+  });
+
+  if(error){
+    std::rethrow_exception(error);
+  }
+
+  return Expression(results);
+}
+
+/*
+ * (reduce <procedure> <list>)
+ * reduce combines the entries of a non-empty list from left to right with a
+ * binary procedure, e.g. (reduce + (list 1 2 3)) is (+ (+ 1 2) 3). A list of
+ * one entry reduces to that entry.
+ *
+ * (fold <procedure> <initial> <list>)
+ * fold is reduce starting from the evaluated initial value, so an empty list
+ * folds to the initial value.
+ *
+ * Over Number (and, for +, Complex) entries, +, *, min and max are reduced
+ * natively as a parallel tree, which may regroup the additions or
+ * multiplications. Any other procedure is called once per entry in order.
+ */
+Expression Expression::handle_reduce(Environment & env, bool fold){
+
+  std::string name = fold ? "fold" : "reduce";
+  std::size_t nargs = fold ? 3 : 2;
+
+  // tail must have 2 (or 3 for fold) arguments or error
+  if(m_tail.size() != nargs){
+    throw SemanticError("Error during evaluation: invalid number of arguments in call to " + name);
+  }
+
+  // tail[0] must be a symbol
+  if( !( m_tail[0].isHeadSymbol() && m_tail[0].isTailEmpty() ) ){
+    throw SemanticError("Error during evaluation: first argument in call to " + name + " is not a Symbol");
+  }
+
+  Atom sym = m_tail[0].head();
+  std::string s = sym.asSymbol();
+
+  // tail[0] must be a built-in or user-defined procedure
+  if( !(env.is_proc(sym) || env.is_anon_proc(sym) || is_special_procedure(s)) ){
+    throw SemanticError("Error during evaluation: first argument to " + name + " is not a Procedure");
+  }
+
+  // the last tail entry must evaluate to a List
+  Expression initial;
+  if(fold){
+    initial = m_tail[1].eval(env);
+  }
+	Expression argsEvaled = m_tail[nargs - 1].eval(env);
+	if(!argsEvaled.isHeadList()){
+    throw SemanticError("Error during evaluation: last argument to " + name + " is not a List");
+  }
+
+  std::size_t n = argsEvaled.listSize();
+  if(n == 0){
+    if(fold) return initial;
+    throw SemanticError("Error during evaluation: reduce of an empty List");
+  }
+
+  // Resolve the procedure once for the whole List
+  Procedure proc = nullptr;
+  Expression lambda;
+  if(env.is_proc(sym)){
+    proc = env.get_proc(sym);
+  }
+  else if(env.is_anon_proc(sym)){
+    lambda = env.get_exp(sym);
+  }
+
+  auto call = [&](const List & args) -> Expression {
+    if(proc) return proc(args);
+    if(lambda.isHeadLambda()) return call_lambda(lambda, args, env);
+    return invoke(sym, args, env);
+  };
+
+  // Reduce the associative built-ins natively when the entries allow it
+  if(proc && (n > 1)){
+    static const std::map<std::string, Reduction> native = {
+      {"+", Reduction::Sum}, {"*", Reduction::Product}, {"min", Reduction::Min}, {"max", Reduction::Max} };
+
+    auto op = native.find(s);
+    PackedArray values;
+    Expression result;
+    if( (op != native.end()) && pack(argsEvaled, values) && packedReduce(values, op->second, result) ){
+      return fold ? call(List{ initial, result }) : result;
+    }
+  }
+
+  Expression result = fold ? call(List{ initial, argsEvaled.listAt(0) }) : argsEvaled.listAt(0);
+  for(std::size_t i = 1; i < n; i++){
+    CancellationToken::check();
+    result = call(List{ result, argsEvaled.listAt(i) });
+  }
+
+  return result;
+}
+
+/*
+ * (continuous-plot <procedure> <bounds>)
+ * (continuous-plot <procedure> <bounds> <options>)
+ * continuous-plot samples a unary procedure of a Number over the interval
+ * given by the List (low high), and draws the samples joined by Lines in the
+ * same layout as discrete-plot. The interval starts out split into
+ * PLOT_SAMPLES pieces; then, up to PLOT_REFINEMENTS times, wherever the
+ * plotted curve bends by more than PLOT_BEND degrees at a sample, both pieces
+ * meeting there are halved. Built-ins and lambdas cannot change the
+ * Environment, so their samples are evaluated in parallel on the thread pool.
+ * A plot of more than 256 (LayoutParams::batch) samples draws each unbroken
+ * run of them as one "polyline" item rather than one "line" item per segment.
+ */
+static const std::size_t PLOT_SAMPLES = 50;
+static const std::size_t PLOT_REFINEMENTS = 10;
+static const double PLOT_BEND = 5.0;
+
+Expression Expression::handle_continuous_plot(Environment & env){
+
+  // tail must have 2 or 3 arguments or error
+  if( (m_tail.size() != 2) && (m_tail.size() != 3) ){
+    throw SemanticError("Error during evaluation: invalid number of arguments in call to continuous-plot");
+  }
+
+  // tail[0] must be a symbol naming a procedure
+  if( !( m_tail[0].isHeadSymbol() && m_tail[0].isTailEmpty() ) ){
+    throw SemanticError("Error during evaluation: first argument in call to continuous-plot is not a Symbol");
+  }
+
+  Atom sym = m_tail[0].head();
+  std::string s = sym.asSymbol();
+
+  if( !(env.is_proc(sym) || env.is_anon_proc(sym) || is_special_procedure(s)) ){
+    throw SemanticError("Error during evaluation: first argument to continuous-plot is not a Procedure");
+  }
+
+  // tail[1] must evaluate to a List of two increasing Numbers
+  Expression bounds = m_tail[1].eval(env);
+  if( !( bounds.isHeadList() && (bounds.listSize() == 2)
+         && bounds.listAt(0).isHeadNumber() && bounds.listAt(1).isHeadNumber()
+         && (bounds.listAt(0).head().asNumber() < bounds.listAt(1).head().asNumber()) ) )
+  {
+    throw SemanticError("Error during evaluation: second argument to continuous-plot is not a List of bounds");
+  }
+  double low = bounds.listAt(0).head().asNumber();
+  double high = bounds.listAt(1).head().asNumber();
+
+  // tail[2], if given, must evaluate to a List of options
+  List options;
+  if(m_tail.size() == 3){
+    Expression optionsEvaled = m_tail[2].eval(env);
+    if(!optionsEvaled.isHeadList()){
+      throw SemanticError("Error during evaluation: third argument to continuous-plot is not a List");
+    }
+    options = optionsEvaled.asList();
+  }
+
+  // Resolve the procedure once for every sample
+  Procedure proc = nullptr;
+  Expression lambda;
+  if(env.is_proc(sym)){
+    proc = env.get_proc(sym);
+  }
+  else if(env.is_anon_proc(sym)){
+    lambda = env.get_exp(sym);
+  }
+
+  // Evaluate the procedure at each of the given abscissas
+  auto sample = [&](const std::vector<double> & xs) -> std::vector<Point> {
+    List args;
+    args.reserve(xs.size());
+    for(double x : xs){
+      args.push_back(Expression(x));
+    }
+
+    List values;
+    if( (proc || lambda.isHeadLambda()) && (xs.size() > 1) ){
+      values = parallel_map(proc, lambda, Expression(args), env).asList();
+    }
+    else{
+      for(auto & arg : args){
+        values.push_back(invoke(sym, List{ arg }, env));
+      }
+    }
+
+    std::vector<Point> points;
+    points.reserve(xs.size());
+    for(std::size_t i = 0; i < xs.size(); i++){
+      if(!values[i].isHeadNumber()){
+        throw SemanticError("Error during evaluation: procedure in call to continuous-plot did not return a Number");
+      }
+      points.push_back(Point(xs[i], values[i].head().asNumber()));
+    }
+    return points;
+  };
+
+  std::vector<double> xs(PLOT_SAMPLES + 1);
+  for(std::size_t i = 0; i <= PLOT_SAMPLES; i++){
+    xs[i] = low + ((high - low) * i) / PLOT_SAMPLES;
+  }
+  std::vector<Point> samples = sample(xs);
+
+  for(std::size_t pass = 0; pass < PLOT_REFINEMENTS; pass++){
 
-  // Apply the Procedure to each entry in the argument List
-  for(auto & argument : argsIn){
-		
-		// Create a new Expression entry in form:
-		//(apply <procedure> (list <argument> <argument> ...))
-		Expression entryExp(Atom("apply"));
-		Expression procedure(sym);
-		
-		// Put the entry in List form required for apply
-		Expression entryArgs(Atom("list"));
-		entryArgs.m_tail = { argument };
+    // measure bends as drawn, i.e. after scaling both axes to the plot box
+    double yMin = INFINITY, yMax = -INFINITY;
+    for(auto & p : samples){
+      if(std::isfinite(p.second)){
+        yMin = std::min(yMin, p.second);
+        yMax = std::max(yMax, p.second);
+      }
+    }
+    double scaleX = 1.0 / (high - low);
+    double scaleY = (yMax > yMin) ? 1.0 / (yMax - yMin) : 1.0;
+
+    // mark the pieces on either side of each sharp bend
+    std::vector<bool> split(samples.size() - 1, false);
+    for(std::size_t i = 1; i + 1 < samples.size(); i++){
+      double ax = scaleX * (samples[i - 1].first - samples[i].first);
+      double ay = scaleY * (samples[i - 1].second - samples[i].second);
+      double bx = scaleX * (samples[i + 1].first - samples[i].first);
+      double by = scaleY * (samples[i + 1].second - samples[i].second);
+
+      // the angle between the pieces, 180 degrees for a straight line
+      double angle = std::abs(std::atan2(ax * by - ay * bx, ax * bx + ay * by)) * (180.0 / std::atan2(0.0, -1.0));
+      if(angle < 180.0 - PLOT_BEND){
+        split[i - 1] = split[i] = true;
+      }
+    }
 
-    // Complete entry and add it to the AST
-		entryExp.m_tail = { procedure, entryArgs };
-		results.m_tail.push_back(entryExp);
+    std::vector<double> mids;
+    for(std::size_t i = 0; i < split.size(); i++){
+      if(split[i]){
+        mids.push_back((samples[i].first + samples[i + 1].first) / 2);
+      }
+    }
+    if(mids.empty()) break;
+
+    // evaluate all the new samples of this pass together, then merge them in
+    std::vector<Point> added = sample(mids);
+    std::vector<Point> merged;
+    merged.reserve(samples.size() + added.size());
+    std::merge(samples.begin(), samples.end(), added.begin(), added.end(), std::back_inserter(merged));
+    samples.swap(merged);
   }
 
-  // Evaluate modified AST and return result
-  return results.eval(env);
+  return Expression(makeContinuousPlot(samples, options));
 }
 
 /*
@@ -1025,8 +2163,17 @@ Expression Expression::get_property(Environment & env)
 // difficult with the ast data structure used (no parent pointer).
 // this limits the practical depth of our AST
 Expression Expression::eval(Environment & env){
-  
-  if( (m_tail.empty()) && (!isHeadList()) ){ // Base Case
+
+  // every node is a point where an interrupted evaluation can stop, before
+  // it has changed anything
+  CancellationToken::check();
+
+  // a List view or Matrix is already a value, its empty tail is not an
+  // argument list
+  if(m_rep){
+    return *this;
+  }
+  else if( (m_tail.empty()) && (!isHeadList()) ){ // Base Case
     return handle_lookup(m_head, env);
   }
   // handle begin special-form
@@ -1049,6 +2196,22 @@ Expression Expression::eval(Environment & env){
   else if(m_head.isSymbol() && m_head.asSymbol() == "map"){
     return handle_map(env);
   }
+  // handle pmap special-form/procedure
+  else if(m_head.isSymbol() && m_head.asSymbol() == "pmap"){
+    return handle_map(env, true);
+  }
+  // handle reduce special-form/procedure
+  else if(m_head.isSymbol() && m_head.asSymbol() == "reduce"){
+    return handle_reduce(env);
+  }
+  // handle fold special-form/procedure
+  else if(m_head.isSymbol() && m_head.asSymbol() == "fold"){
+    return handle_reduce(env, true);
+  }
+  // handle continuous-plot special-form/procedure
+  else if(m_head.isSymbol() && m_head.asSymbol() == "continuous-plot"){
+    return handle_continuous_plot(env);
+  }
   // handle set-property special-form/procedure
   else if(m_head.isSymbol() && m_head.asSymbol() == "set-property"){
     return set_property(env);
@@ -1069,43 +2232,52 @@ Expression Expression::eval(Environment & env){
   }
 }
 
+// Call the procedure a symbol names on already evaluated arguments, without
+// building an AST, except for the special-form procedures, which need one
+Expression Expression::invoke(const Atom & sym, const List & args, Environment & env){
+
+  if(env.is_proc(sym)){
+    return env.get_proc(sym)(args);
+  }
+  else if(env.is_anon_proc(sym)){
+    Expression lambda = env.get_exp(sym);
+    return call_lambda(lambda, args, env);
+  }
+
+  // Set up restructured AST in form: (<procedure> <argument> <argument> ...)
+  Expression result = Expression(sym);
+  result.m_tail = args;
+
+  return result.eval(env);
+}
+
 // Use values passed into Lambda Parameters by the anonymous function call to
 // evaluate user-defined procedure, calculate resulting value
 Expression Expression::call_lambda(Expression & lambda, const List & args, const Environment & env){
 	
-	// Make it easier to access arguments (I'll change later)
-	List argsIn = Expression(args).asList();
-
 	// Extract lambda pieces
-	List params = lambda.m_tail[0].m_tail;
-	Expression function = lambda.m_tail[1];
+	const List & params = lambda.m_tail[0].m_tail;
 
 	// Function call must match number of defined arguments or error
-  if(params.size() != argsIn.size()) {
+  if(params.size() != args.size()) {
 		throw SemanticError("Error during evaluation: invalid number of arguments to call lambda function");
   }
 
 	// Copy construct a new temporary Environment for Lambda evaluation
 	Environment shadowEnv(env);
 
-	// Set up restructured AST in form: (begin <expression> <expression> ...)
-	Expression shadowAST(Atom("begin"));
-
-	// Assign a value to each parameter
+	// Bind each parameter to its (already evaluated) argument value
 	for(size_t i = 0; i < params.size(); i++) {
-		// Create a new special-form Expression: (define <symbol> <expression>)
-		Expression argDef(Atom("define"));
-		argDef.m_tail = {params[i], argsIn[i]};
-
-		// Add it to the AST
-		shadowAST.m_tail.push_back(argDef);
+		std::string s = params[i].head().asSymbol();
+		if((s == "define") || (s == "begin") || (s == "lambda")){
+			throw SemanticError("Error during evaluation: attempt to redefine a special-form");
+		}
+		shadowEnv.add_exp(params[i].head(), args[i]);
 	}
 
-	// Lastly, add the stored function definition
-	shadowAST.m_tail.push_back(function);
-	
-	// Evaluate modified AST in Shadow and return result to the Main Environment
-	return shadowAST.eval(shadowEnv);
+	// Lastly, evaluate the stored function definition in place, so call sites
+	// linked by earlier calls stay linked, and return result to the Main Environment
+	return lambda.m_tail[1].eval(shadowEnv);
 }
 
 std::ostream & operator<<(std::ostream & out, const Expression & exp){
@@ -1115,6 +2287,27 @@ std::ostream & operator<<(std::ostream & out, const Expression & exp){
     return out;
   }
 
+  // print a List view through its entries
+  if(exp.isListView()){
+    out << Expression(exp.asList());
+    return out;
+  }
+
+  // print a Matrix as the List of rows it converts to
+  if(exp.isHeadMatrix()){
+    const Matrix & m = *exp.asMatrix();
+    out << "(";
+    for(std::size_t i = 0; i < m.rows(); i++){
+      out << ((i == 0) ? "(" : " (");
+      for(std::size_t j = 0; j < m.cols(); j++){
+        out << ((j == 0) ? "(" : " (") << Atom(m(i, j)) << ")";
+      }
+      out << ")";
+    }
+    out << ")";
+    return out;
+  }
+
   out << "(";
   
   if( (!exp.isHeadList()) && (!exp.isHeadLambda()) ){
@@ -1141,6 +2334,20 @@ bool Expression::operator==(const Expression & exp) const noexcept{
 
   bool result = (m_head == exp.m_head);
 
+  // compare Matrices by shape and entries
+  if(isHeadMatrix() || exp.isHeadMatrix()){
+    return result && isHeadMatrix() && exp.isHeadMatrix() && (*asMatrix() == *exp.asMatrix());
+  }
+
+  // compare a List view entry by entry, with any form of List
+  if(isListView() || exp.isListView()){
+    result = result && (listSize() == exp.listSize());
+    for(std::size_t i = 0; result && (i < listSize()); i++){
+      result = (listAt(i) == exp.listAt(i));
+    }
+    return result;
+  }
+
   result = result && (m_tail.size() == exp.m_tail.size());
 
   if(result){ // Recursively compare each of the tail expressions
@@ -12,10 +12,27 @@ Defines the Expression type and assiciated functions.
 #include <string>
 #include <utility>
 #include <map>
+#include <memory>
+#include <cstddef>
 
 // forward declare Environment
 class Environment;
 
+// forward declare Expression
+class Expression;
+
+// forward declare ListStore
+class ListStore;
+
+// forward declare Matrix
+class Matrix;
+
+/*! \typedef Procedure
+\brief A Procedure is a C++ function pointer taking a vector of 
+       Expressions as arguments and returning an Expression.
+*/
+typedef Expression (*Procedure)(const std::vector<Expression> & args);
+
 /*! \class Expression
 \brief An expression is a tree of Atoms.
 
@@ -30,6 +47,58 @@ public:
   typedef std::vector<Expression> List;
   typedef std::pair<List, Expression> Lambda;
 	typedef std::pair<double, double> Point;
+
+  /// a property key, interned so property lists never compare key strings
+  typedef unsigned int PropertyId;
+
+  /// the property keys used by the graphic primitives, interned up front
+  enum GraphicProperty : PropertyId {
+    OBJECT_NAME, SIZE, THICKNESS, POSITION, TEXT_SCALE, TEXT_ROTATION
+  };
+
+  /// the kind of graphic primitive an Expression is tagged as by its
+  /// "object-name" property, cached whenever that property is set
+  enum class GraphicKind : unsigned char { None, Point, Line, Text, PointCloud, Polyline };
+
+  /// a Graphic Primitive Point read into numbers, size 0 unless set
+  struct PointG {
+    double x = 0.0;
+    double y = 0.0;
+    double size = 0.0;
+  };
+
+  /// a Graphic Primitive Line read into numbers, thickness 1 unless set
+  struct LineG {
+    double x1 = 0.0;
+    double y1 = 0.0;
+    double x2 = 0.0;
+    double y2 = 0.0;
+    double thickness = 1.0;
+  };
+
+  /// a Graphic Primitive Point Cloud read into numbers, size 0 unless set
+  struct PointCloudG {
+    std::vector<double> xs;
+    std::vector<double> ys;
+    double size = 0.0;
+  };
+
+  /// a Graphic Primitive Polyline read into numbers, thickness 1 unless set
+  struct PolylineG {
+    std::vector<double> xs;
+    std::vector<double> ys;
+    double thickness = 1.0;
+  };
+
+  /// a Graphic Primitive Text read into numbers, centered on the origin
+  /// with scale 1 and rotation 0 (radians) unless set
+  struct TextG {
+    String text;
+    double x = 0.0;
+    double y = 0.0;
+    double scale = 1.0;
+    double rotation = 0.0;
+  };
   
   // convenience typedef
   typedef std::vector<Expression>::const_iterator ConstIteratorType;
@@ -45,6 +114,9 @@ public:
   /// deep-copy construct an expression (recursive)
   Expression(const Expression & a);
 
+  /// move construct an expression, taking over its tail without copying
+  Expression(Expression && a) noexcept;
+
   // List Type constructor
   Expression(const List & list);
   
@@ -54,6 +126,9 @@ public:
   /// deep-copy assign an expression  (recursive)
   Expression & operator=(const Expression & a);
 
+  /// move assign an expression, taking over its tail without copying
+  Expression & operator=(Expression && a) noexcept;
+
   /// return a reference to the head Atom
   Atom & head();
 
@@ -96,20 +171,70 @@ public:
   /// convienience member to determine if head atom is a lambda
   bool isHeadLambda() const noexcept;
 
+  /// convienience member to determine if Expression is a List kept as a lazy range
+  bool isLazyRange() const noexcept;
+
+  /// convienience member to determine if a List keeps its entries outside its
+  /// tail, as a lazy range or as a slice of a ListStore
+  bool isListView() const noexcept;
+
+  /// convienience member to determine if Expression is a Matrix
+  bool isHeadMatrix() const noexcept;
+
   /// value of Expression as a List vector, return empty List vector if not a List
   List asList() const noexcept;
 
+  /// the Matrix an Expression holds, or nullptr if not a Matrix
+  const Matrix * asMatrix() const noexcept;
+
+  /// number of entries in a List, without materializing a lazy range
+  std::size_t listSize() const noexcept;
+
+  /// entry i of a List (i < listSize()), without materializing a lazy range
+  Expression listAt(std::size_t i) const noexcept;
+
+  /// a List of all but the first entry of a non-empty List, in O(1) once the
+  /// List is a slice of a ListStore
+  Expression listRest() const;
+
+  /// a List with entry added at the end, in amortized O(1)
+  Expression listAppend(const Expression & entry) const;
+
+  /// a List of the entries of this List followed by those of other, in time
+  /// proportional to the length of other
+  Expression listJoin(const Expression & other) const;
+
   /// value of Expression as a Lambda pair (params, proc), return empty pair if not a Lambda
   Lambda asLambda() const noexcept;
 
   // Convenience member for external checks
   String asString() const noexcept;
 
+  /// the id of a property key (a String literal, with its quotes),
+  /// interning the key on first use; safe to call from several threads
+  static PropertyId propertyId(const String & key);
+
+  /// look up the id of a property key without interning it
+  /// \return false if the key has never been interned, so is set on nothing
+  static bool findPropertyId(const String & key, PropertyId & id) noexcept;
+
   // Convenient helper method for special-form equivalent
   void setProperty(const String key, Expression value);
 
+  /// add or reset the property with an interned key
+  void setProperty(PropertyId id, Expression value);
+
 	// Convenient helper method for special-form equivalent
 	Expression getProperty(const String key) const noexcept;
+
+  /// the property with an interned key, or None if not set
+  Expression getProperty(PropertyId id) const noexcept;
+
+  /// pointer to the property with an interned key, or nullptr if not set
+  const Expression * findProperty(PropertyId id) const noexcept;
+
+  /// the graphic primitive kind this Expression is tagged as, if any
+  GraphicKind graphicKind() const noexcept;
   
   /// convienience member to determine if Expression is a Graphic Primitive Point
   bool isPointG() const noexcept;
@@ -120,8 +245,64 @@ public:
   /// convienience member to determine if Expression is a Graphic Primitive Text
   bool isTextG() const noexcept;
 
-	// Convenient helper method for built-in procedure equivalent
-	static List makeDiscretePlot(const List & data, const List & options);
+  /// convienience member to determine if Expression is a Graphic Primitive
+  /// Point Cloud, a List of Numbers x1 y1 x2 y2 ... drawn as one item
+  bool isPointCloudG() const noexcept;
+
+  /// convienience member to determine if Expression is a Graphic Primitive
+  /// Polyline, a List of Numbers x1 y1 x2 y2 ... joined in order by Lines
+  bool isPolylineG() const noexcept;
+
+  /// value of a Graphic Primitive Point, false if not one or its "size" is
+  /// set to anything but a positive Number
+  bool asPointG(PointG & point) const noexcept;
+
+  /// value of a Graphic Primitive Line, false if not one, if an end is not a
+  /// List of two Numbers, or if its "thickness" is set to anything but a
+  /// non-negative Number
+  bool asLineG(LineG & line) const noexcept;
+
+  /// value of a Graphic Primitive Point Cloud, false if not one or its
+  /// "size" is set to anything but a positive Number
+  bool asPointCloudG(PointCloudG & cloud) const noexcept;
+
+  /// value of a Graphic Primitive Polyline, false if not one or its
+  /// "thickness" is set to anything but a non-negative Number
+  bool asPolylineG(PolylineG & line) const noexcept;
+
+  /// value of a Graphic Primitive Text, false if not one or its "position"
+  /// is set to anything but a Point; a "text-scale" that is not a positive
+  /// Number, or a "text-rotation" that is not a Number, is ignored
+  bool asTextG(TextG & text) const noexcept;
+
+	// Convenient helper method for built-in procedure equivalent, dropped is
+	// set to the number of data points left out by decimation
+	static List makeDiscretePlot(const Expression & data, const List & options, std::size_t & dropped);
+
+  /// lay out function samples (x, y), sorted by x, as a continuous-plot
+  static List makeContinuousPlot(const std::vector<Point> & samples, const List & options);
+
+  /// make a Graphic Primitive Point from two coordinate Expressions
+  static Expression makePointG(const Expression & x, const Expression & y);
+
+  /// make a Graphic Primitive Line from two Point Expressions
+  static Expression makeLineG(const Expression & p1, const Expression & p2);
+
+  /// make a Graphic Primitive Text from a String Expression
+  static Expression makeTextG(const Expression & text);
+
+  /// make a Graphic Primitive Point Cloud of the points (xs[i], ys[i])
+  static Expression makePointCloudG(const std::vector<double> & xs, const std::vector<double> & ys);
+
+  /// make a Graphic Primitive Polyline through the points (xs[i], ys[i])
+  static Expression makePolylineG(const std::vector<double> & xs, const std::vector<double> & ys);
+
+  /// make a List of size Numbers low, low + step, ... no greater than high,
+  /// stored as the arithmetic sequence rather than as entries
+  static Expression makeRange(double low, double high, double step, std::size_t size);
+
+  /// make a Matrix Expression, whose copies share the entries read-only
+  static Expression makeMatrix(Matrix matrix);
 
   /// Evaluate expression using a post-order traversal (recursive)
   Expression eval(Environment & env);
@@ -141,8 +322,34 @@ private:
   // and cache coherence, at the cost of wasted memory.
   std::vector<Expression> m_tail;
 
-  // Property list
-  std::map<String, Expression> m_props;
+  // Property list, a handful of (id, value) entries in the order set
+  std::vector<std::pair<PropertyId, Expression>> m_props;
+
+  // graphic kind given by the "object-name" property
+  GraphicKind m_graphic = GraphicKind::None;
+
+  // A lazy range, a slice of a shared store, or a Matrix: Lists and values
+  // stored other than as a tail. They are rare next to plain Atoms, so they
+  // are kept out of line, immutable and shared by copies, and nullptr for
+  // everything else
+  struct Representation;
+  std::shared_ptr<const Representation> m_rep;
+
+  // a slice of a new store holding the entries of this List
+  Expression toSlice() const;
+
+  // fill the tail of a List view with its entries
+  void materialize();
+
+  // drop the inline caches of this Expression and its tail (recursive)
+  void unlink() noexcept;
+
+  // Per-call-site inline cache of the binding the head symbol resolved to,
+  // valid while the matching Environment version stamp is unchanged
+  Procedure m_proc = nullptr;
+  unsigned long m_procVersion = 0;
+  std::shared_ptr<Expression> m_lambda;
+  unsigned long m_lambdaVersion = 0;
 
   // convenience typedef
   typedef std::vector<Expression>::iterator IteratorType;
@@ -154,9 +361,14 @@ private:
   Expression handle_lambda();
   
   // Built-In Functions
+  Expression invoke(const Atom & sym, const List & args, Environment & env);
   Expression call_lambda(Expression & lambda, const List & args, const Environment & env);
   Expression handle_apply(Environment & env);
-  Expression handle_map(Environment & env);
+  Expression handle_map(Environment & env, bool parallel = false);
+  Expression parallel_map(Procedure proc, const Expression & lambda,
+                          const Expression & argsEvaled, const Environment & env);
+  Expression handle_reduce(Environment & env, bool fold = false);
+  Expression handle_continuous_plot(Environment & env);
   Expression set_property(Environment & env);
   Expression get_property(Environment & env);
 };
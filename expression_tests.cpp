@@ -347,6 +347,178 @@ TEST_CASE("Test Expression assignment", "[expression]") {
   }
 }
 
+TEST_CASE( "Test Expression moves", "[expression]" ) {
+
+  Expression::List items = { Expression(1.0), Expression(Atom("\"a\"")), Expression(2.0) };
+  Expression list(items);
+  list.setProperty("\"k\"", Expression(3.0));
+  const Expression * entries = &*list.tailConstBegin();
+
+  INFO("a moved List keeps its entries where they were");
+  Expression moved(std::move(list));
+  REQUIRE(moved == Expression(items));
+  REQUIRE(&*moved.tailConstBegin() == entries);
+  REQUIRE(moved.getProperty("\"k\"") == Expression(3.0));
+
+  Expression assigned(4.0);
+  assigned = std::move(moved);
+  REQUIRE(assigned == Expression(items));
+  REQUIRE(&*assigned.tailConstBegin() == entries);
+
+  INFO("views and Lambdas move too");
+  Expression range = Expression::makeRange(1.0, 3.0, 1.0, 3);
+  Expression movedRange(std::move(range));
+  REQUIRE(movedRange.isLazyRange());
+  REQUIRE(movedRange.listSize() == 3);
+
+  Expression lambda(Expression::List{ Expression(Atom("x")) }, Expression(Atom("x")));
+  Expression movedLambda = std::move(lambda);
+  REQUIRE(movedLambda.isHeadLambda());
+}
+
+TEST_CASE( "Test lazy range Lists", "[expression]" ) {
+
+  Expression range = Expression::makeRange(0.0, 1.0, 0.25, 5);
+  Expression::List entries = { Expression(0.0), Expression(0.25), Expression(0.5),
+                               Expression(0.75), Expression(1.0) };
+
+  REQUIRE(range.isHeadList());
+  REQUIRE(range.isLazyRange());
+  REQUIRE(range.listSize() == 5);
+  REQUIRE(range.listAt(3) == Expression(0.75));
+
+  INFO("a lazy range equals the same entries as a List either way around");
+  REQUIRE(range == Expression(entries));
+  REQUIRE(Expression(entries) == range);
+  REQUIRE(range.asList() == entries);
+
+  INFO("copies stay lazy, edits materialize");
+  Expression copy = range;
+  REQUIRE(copy.isLazyRange());
+  copy.append(Atom(2.0));
+  REQUIRE(!copy.isLazyRange());
+  REQUIRE(copy.listSize() == 6);
+  REQUIRE(range.listSize() == 5);
+
+  INFO("an empty range is an ordinary empty List");
+  Expression empty = Expression::makeRange(0.0, 1.0, 1.0, 0);
+  REQUIRE(!empty.isLazyRange());
+  REQUIRE(empty == Expression(Expression::List()));
+}
+
+TEST_CASE( "Test List slices", "[expression]" ) {
+
+  Expression list(Expression::List{ Expression(1.0), Expression(2.0), Expression(3.0) });
+
+  Expression rest = list.listRest();
+  REQUIRE(rest.isListView());
+  REQUIRE(rest == Expression(Expression::List{ Expression(2.0), Expression(3.0) }));
+  REQUIRE(rest.listRest().listRest() == Expression(Expression::List()));
+
+  INFO("appending to a List that ends where its store ends extends it in place");
+  Expression a = rest.listAppend(Expression(4.0));
+  Expression b = a.listAppend(Expression(5.0));
+  REQUIRE(a == Expression(Expression::List{ Expression(2.0), Expression(3.0), Expression(4.0) }));
+  REQUIRE(b.listSize() == 4);
+  REQUIRE(b.listAt(3) == Expression(5.0));
+
+  INFO("appending to an older version leaves the newer ones unchanged");
+  Expression c = a.listAppend(Expression(6.0));
+  REQUIRE(c.listAt(3) == Expression(6.0));
+  REQUIRE(b.listAt(3) == Expression(5.0));
+  REQUIRE(rest.listSize() == 2);
+
+  INFO("joins copy only the second List");
+  Expression joined = b.listJoin(list);
+  REQUIRE(joined.listSize() == 7);
+  REQUIRE(joined.listAt(6) == Expression(3.0));
+  REQUIRE(Expression(Expression::List()).listJoin(list) == list);
+
+  INFO("a range rests to the same sequence further along");
+  Expression range = Expression::makeRange(0.0, 1.0, 0.1, 11);
+  REQUIRE(range.listRest().listAt(2) == range.listAt(3));
+  REQUIRE(range.listRest().isLazyRange());
+
+  INFO("editing a slice gives it its own tail");
+  Expression edited = b;
+  edited.append(Atom(7.0));
+  REQUIRE(!edited.isListView());
+  REQUIRE(edited.listSize() == 5);
+  REQUIRE(b.listSize() == 4);
+}
+
+TEST_CASE( "Test property ids and typed graphic primitives", "[expression]" ) {
+
+  INFO("keys are interned once, the graphic keys up front");
+  REQUIRE(Expression::propertyId("\"object-name\"") == Expression::OBJECT_NAME);
+  REQUIRE(Expression::propertyId("\"text-rotation\"") == Expression::TEXT_ROTATION);
+  Expression::PropertyId key = Expression::propertyId("\"some-key\"");
+  REQUIRE(Expression::propertyId("\"some-key\"") == key);
+  REQUIRE(key != Expression::propertyId("\"other-key\""));
+
+  INFO("reading a property never interns its key");
+  Expression::PropertyId found;
+  REQUIRE(Expression::findPropertyId("\"size\"", found));
+  REQUIRE(found == Expression::SIZE);
+  REQUIRE(Expression::findPropertyId("\"some-key\"", found));
+  REQUIRE(found == key);
+  REQUIRE(!Expression::findPropertyId("\"read-only-key\"", found));
+  REQUIRE(Expression(1.0).getProperty("\"read-only-key\"") == Expression());
+  REQUIRE(!Expression::findPropertyId("\"read-only-key\"", found));
+
+  INFO("String and id keys name the same property");
+  Expression exp(Expression::List{ Expression(1.0), Expression(2.0) });
+  exp.setProperty("\"some-key\"", Expression(3.0));
+  REQUIRE(exp.getProperty(key) == Expression(3.0));
+  exp.setProperty(key, Expression(4.0));
+  REQUIRE(exp.getProperty("\"some-key\"") == Expression(4.0));
+  REQUIRE(exp.findProperty(Expression::SIZE) == nullptr);
+  REQUIRE(exp.getProperty(Expression::SIZE) == Expression());
+
+  INFO("setting object-name classifies the primitive");
+  REQUIRE(exp.graphicKind() == Expression::GraphicKind::None);
+  exp.setProperty("\"object-name\"", Expression(Atom("\"point\"")));
+  REQUIRE(exp.graphicKind() == Expression::GraphicKind::Point);
+  REQUIRE(exp.isPointG());
+
+  Expression::PointG point;
+  REQUIRE(exp.asPointG(point));
+  REQUIRE(point.x == 1.0);
+  REQUIRE(point.y == 2.0);
+  REQUIRE(point.size == 0.0);
+  exp.setProperty(Expression::SIZE, Expression(-1.0));
+  REQUIRE(!exp.asPointG(point));
+
+  Expression copy = exp;
+  REQUIRE(copy.isPointG());
+  copy.setProperty(Expression::OBJECT_NAME, Expression(Atom("\"other\"")));
+  REQUIRE(copy.graphicKind() == Expression::GraphicKind::None);
+  REQUIRE(exp.isPointG());
+
+  Expression p1 = Expression::makePointG(Expression(0.0), Expression(1.0));
+  Expression p2 = Expression::makePointG(Expression(2.0), Expression(3.0));
+  Expression line = Expression::makeLineG(p1, p2);
+  Expression::LineG lineG;
+  REQUIRE(line.asLineG(lineG));
+  REQUIRE(lineG.x2 == 2.0);
+  REQUIRE(lineG.y2 == 3.0);
+  REQUIRE(lineG.thickness == 1.0);
+  REQUIRE(!Expression::makeLineG(Expression(1.0), Expression(2.0)).asLineG(lineG));
+  REQUIRE(!exp.asLineG(lineG));
+
+  Expression text = Expression::makeTextG(Expression(Atom("\"hi\"")));
+  text.setProperty(Expression::POSITION, p2);
+  text.setProperty(Expression::TEXT_SCALE, Expression(2.0));
+  Expression::TextG textG;
+  REQUIRE(text.asTextG(textG));
+  REQUIRE(textG.text == "hi");
+  REQUIRE(textG.x == 2.0);
+  REQUIRE(textG.scale == 2.0);
+  REQUIRE(textG.rotation == 0.0);
+  text.setProperty(Expression::POSITION, Expression(1.0));
+  REQUIRE(!text.asTextG(textG));
+}
+
 // All other tests of eval, apply, and private helper methods
 // will be done as integration tests in interpreter_tests because
 // the Expression methods require an associated Environment
@@ -3,6 +3,7 @@
 // system includes
 #include <stdexcept>
 #include <iostream>
+#include <mutex>
 
 // module includes
 #include "token.hpp"
@@ -16,33 +17,63 @@ Interpreter::Interpreter()
 {
 	inputQ = nullptr;
 	outputQ = nullptr;
+	inputChannel = nullptr;
+	outputChannel = nullptr;
 }
 
 Interpreter::Interpreter(MessageQueue<Message> * inQ, MessageQueue<Message> * outQ)
 {
 	inputQ = inQ;
 	outputQ = outQ;
-	startup();
+	inputChannel = nullptr;
+	outputChannel = nullptr;
+	reset();
+}
+
+Interpreter::Interpreter(SpscQueue<Message> * inQ, SpscQueue<Message> * outQ)
+{
+	inputQ = nullptr;
+	outputQ = nullptr;
+	inputChannel = inQ;
+	outputChannel = outQ;
+	reset();
+}
+
+const Environment & Interpreter::snapshot()
+{
+	static Environment postStartup;
+	static std::once_flag once;
+
+	// Evaluated once per process, the first time a kernel is created.
+	// Assignment keeps the fork a global (non-Lambda) Environment.
+	std::call_once(once, [](){
+		Interpreter interp;
+		interp.startup();
+		postStartup = interp.env;
+	});
+
+	return postStartup;
+}
+
+void Interpreter::reset()
+{
+	// Fork the snapshot copy-on-write instead of re-running startup; lambdas
+	// it defines are linked in place by calls, so each kernel copies them
+	env = snapshot();
+	env.isolate();
 }
 
 void Interpreter::startup()
 {
-  std::ifstream ifs(STARTUP_FILE);
-	std::string strResult;
+	// The start-up program is embedded at build time, no file to open
+	std::istringstream iss(STARTUP_PROGRAM);
 	Message result;
 
-  if( (!ifs) && (outputQ != nullptr) ){
-    strResult = "Error: Could not open startup file for reading.";
-		//outputQ->push(Message(Message::Type::ErrorType, strResult));
-  }
-
 	// Only send message for evaluation errors
-	result = evalStream(ifs);
+	result = evalStream(iss);
 	if( result.isError() && (outputQ != nullptr) ){
 		//outputQ->push(result);
 	}
-
-	ifs.close();
 }
 
 //void Interpreter::operator()() const
@@ -76,27 +107,76 @@ void Interpreter::threadEvalLoop()
 	while(true){
 
 		// Take a unit of work from the input queue
-		Message line;
-		inputQ->wait_and_pop(line);
+		Message line = receive();
 
 		// Check for special kernel control commands
 		if(line.getString() == "%stop") break;
 		if(line.getString() == "%exit") break;
 		if(line.getString() == "%reset"){
 			// Clear and reset the Environment
-			env.reset();
-			startup();
+			reset();
 			break;
 		}
 		
-		// Process input and add result to output MessageQueue
-		std::istringstream inStream(line.getString());
-		//Message result = evalStream(inStream);/*** Not thread-safe ***/
-		outputQ->push(Message(evalStream(inStream)));
+		// Clear the last interrupt before checking whether this request was
+		// submitted ahead of one; interrupt sets the cut-off first, so a
+		// request either falls under it or sees the token cancelled
+		unsigned long id = line.getRequestId();
+		cancelToken.reset();
+
+		// Process input and add result, tagged with the request id, to output MessageQueue
+		Message result;
+		if( (id != 0) && (id <= cancelledThrough) ){
+			result = Message(Message::Type::ErrorType, CancellationToken::INTERRUPTED);
+		}
+		else{
+			std::istringstream inStream(line.getString());
+			result = evalStream(inStream);
+		}
+		result.setRequestId(id);
+		send(std::move(result));
 	}
 	// End of Program
 }
 
+Message Interpreter::receive()
+{
+	Message line;
+	if(inputChannel != nullptr){
+		inputChannel->wait_and_pop(line);
+	}
+	else{
+		inputQ->wait_and_pop(line);
+	}
+	return line;
+}
+
+void Interpreter::send(Message && result)
+{
+	if(outputChannel != nullptr){
+		outputChannel->push(std::move(result));
+	}
+	else{
+		outputQ->push(std::move(result));
+	}
+}
+
+unsigned long Interpreter::submit(const std::string & program)
+{
+	unsigned long id = ++lastRequestId;
+
+	Message request(Message::Type::StringType, program);
+	request.setRequestId(id);
+	if(inputChannel != nullptr){
+		inputChannel->push(std::move(request));
+	}
+	else{
+		inputQ->push(std::move(request));
+	}
+
+	return id;
+}
+
 Message Interpreter::evalStream(std::istream & stream){
 	
 	std::ostringstream outStream;
@@ -110,8 +190,8 @@ Message Interpreter::evalStream(std::istream & stream){
 	}
 	else{
 		try{
-			expResult = evaluate();
-			result = Message(Message::Type::ExpressionType, expResult);
+			expResult = evaluateAst();
+			result = Message(Message::Type::ExpressionType, std::move(expResult));
 		}
 		catch(const SemanticError & ex){
 			outStream << ex.what();
@@ -138,5 +218,23 @@ bool Interpreter::parseStream(std::istream & expression) noexcept{
 
 Expression Interpreter::evaluate(){
 
+  // an interrupt only applies to the evaluation running when it is sent
+  cancelToken.reset();
+
+  return evaluateAst();
+}
+
+Expression Interpreter::evaluateAst(){
+
+  CancellationScope scope(&cancelToken);
+
   return ast.eval(env);
 }
+
+void Interpreter::interrupt() noexcept{
+
+  // only atomic stores, so a signal handler may call this while the kernel
+  // thread drains its queue
+  cancelledThrough = lastRequestId.load();
+  cancelToken.cancel();
+}
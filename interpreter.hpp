@@ -8,6 +8,7 @@ It maintains an environment during evaluation.
 #define INTERPRETER_HPP
 
 // system includes
+#include <atomic>
 #include <iostream>
 #include <fstream>
 #include <istream>
@@ -21,7 +22,9 @@ It maintains an environment during evaluation.
 #include "semantic_error.hpp"
 //#include "startup_config.hpp"
 #include "message_queue.hpp"
+#include "spsc_queue.hpp"
 #include "message.hpp"
+#include "cancellation.hpp"
 
 /*! \class Interpreter
 \brief Class to parse and evaluate an expression (program)
@@ -35,20 +38,34 @@ public:
 	
 	Interpreter();
 
+	/// A kernel sharing its queues, e.g. with the other kernels of an InterpreterPool
 	Interpreter(MessageQueue<Message> * inputQ, MessageQueue<Message> * outputQ);
+
+	/// A lone kernel, fed by one thread and answering one thread, as in the REPL
+	Interpreter(SpscQueue<Message> * inputQ, SpscQueue<Message> * outputQ);
 	
 	// Overloaded function call operator to start threads in
 	//void Interpreter::operator()() const;
 
-	/// Open the start-up file and evaluate the program
+	/// Evaluate the start-up program embedded at build time
 	void startup();
 
-	/// Main thread function that polls the input MessageQueue until interrupt message is received
+	/// Restore the Environment to the state left by the start-up program without re-running it
+	void reset();
+
+	/// Main thread function that polls the input queue until interrupt message is received
 	void threadEvalLoop();
 	
 	/// Process the input message and return result message
 	Message evalStream(std::istream & stream);
 
+	/*! Queue a program for the kernel thread without waiting for its result,
+	  so several can be in flight at once. Results are pushed to the output
+	  queue in submission order.
+	  \return the request id carried by the program's result
+	 */
+	unsigned long submit(const std::string & program);
+
   /*! Parse into an internal Expression from a stream
     \param expression the raw text stream repreenting the candidate expression
     \return true on successful parsing 
@@ -61,15 +78,48 @@ public:
    */
   Expression evaluate();
 
+  /*! Ask the running evaluation to stop; it throws SemanticError
+    "Error: interpreter kernel interrupted" at its next check, as if it had
+    encountered a semantic error there: defines already made by the
+    interrupted expression are kept.
+    Programs already submitted to the kernel thread are cancelled too, and
+    answered with the same error without being evaluated.
+    Safe to call from another thread or a signal handler.
+   */
+  void interrupt() noexcept;
+
 private:
   
+	/// Immutable post-startup Environment, built once and forked by every kernel
+	static const Environment & snapshot();
+
 	Environment env;
 	
 	Expression ast;
 
+	/// Cancelled by interrupt, checked by the evaluation in progress
+	CancellationToken cancelToken;
+
 	/// The thread-safe message queue channels for kernel I/O
 	MessageQueue<Message> * inputQ;
 	MessageQueue<Message> * outputQ;
+
+	/// Or the single-producer single-consumer channels of a lone kernel
+	SpscQueue<Message> * inputChannel;
+	SpscQueue<Message> * outputChannel;
+
+	/// Evaluate the AST under cancelToken, without clearing an earlier interrupt
+	Expression evaluateAst();
+
+	/// Take the next request from, and send a result to, whichever channels are set
+	Message receive();
+	void send(Message && result);
+
+	/// The id given to the last submitted program, 0 before the first
+	std::atomic<unsigned long> lastRequestId{0};
+
+	/// Requests with ids up to this one were submitted before an interrupt
+	std::atomic<unsigned long> cancelledThrough{0};
   
 };
 
@@ -0,0 +1,67 @@
+#include "interpreter_pool.hpp"
+
+// system includes
+#include <algorithm>
+
+InterpreterPool::InterpreterPool(std::size_t n, MessageQueue<Message> * inQ, MessageQueue<Message> * outQ)
+{
+	inputQ = inQ;
+
+	// Each kernel forks the startup snapshot as it is constructed
+	n = std::max<std::size_t>(n, 1);
+	for(std::size_t i = 0; i < n; i++){
+		kernels.emplace_back(new Interpreter(inQ, outQ));
+	}
+}
+
+InterpreterPool::~InterpreterPool()
+{
+	stop();
+}
+
+std::size_t InterpreterPool::size() const noexcept
+{
+	return kernels.size();
+}
+
+bool InterpreterPool::isRunning() const noexcept
+{
+	return !threads.empty();
+}
+
+void InterpreterPool::start()
+{
+	if(isRunning()) return;
+
+	for(auto & kernel : kernels){
+		threads.emplace_back(&Interpreter::threadEvalLoop, kernel.get());
+	}
+}
+
+void InterpreterPool::stop()
+{
+	signal("%stop");
+}
+
+void InterpreterPool::reset()
+{
+	// Each kernel resets its own Environment as it takes its %reset
+	signal("%reset");
+	start();
+}
+
+void InterpreterPool::signal(const std::string & command)
+{
+	if(!isRunning()) return;
+
+	// A kernel leaves its loop after taking one command, so one command per
+	// kernel reaches all of them, each behind the requests already queued
+	for(std::size_t i = 0; i < threads.size(); i++){
+		inputQ->push(Message(Message::Type::StringType, command));
+	}
+
+	for(auto & thread : threads){
+		thread.join();
+	}
+	threads.clear();
+}
@@ -0,0 +1,73 @@
+/*! \file interpreter_pool.hpp
+
+Runs several interpreter kernels at once, each on its own thread, all
+serving the same pair of message queues.
+ */
+
+#ifndef INTERPRETER_POOL_HPP
+#define INTERPRETER_POOL_HPP
+
+// system includes
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// module includes
+#include "interpreter.hpp"
+#include "message_queue.hpp"
+#include "message.hpp"
+
+/*! \class InterpreterPool
+\brief A fixed set of interpreter kernels answering independent requests.
+
+Every kernel forks its own Environment from the post-startup snapshot. All
+kernels wait on the shared input queue, so each request is taken by
+whichever kernel is idle. A kernel keeps its own definitions, but any kernel
+may take the next request, so requests should be independent programs.
+Results are pushed to the output queue as they finish, possibly out of
+order, each carrying the request id of the Message it answers.
+*/
+class InterpreterPool{
+public:
+
+	/*! Create, but do not start, the kernels
+	  \param kernels the number of kernels (at least one)
+	  \param inputQ the queue the kernels take requests from
+	  \param outputQ the queue the kernels push results to
+	 */
+	InterpreterPool(std::size_t kernels, MessageQueue<Message> * inputQ, MessageQueue<Message> * outputQ);
+
+	/// Stop any running kernels
+	~InterpreterPool();
+
+	InterpreterPool(const InterpreterPool &) = delete;
+	InterpreterPool & operator=(const InterpreterPool &) = delete;
+
+	/// number of kernels
+	std::size_t size() const noexcept;
+
+	/// true if the kernels are running
+	bool isRunning() const noexcept;
+
+	/// Start a thread for every kernel, no effect if already running
+	void start();
+
+	/// Stop every kernel once the requests queued so far are taken, no effect if already stopped
+	void stop();
+
+	/// Stop every kernel, restore each Environment to the snapshot, and start them again
+	void reset();
+
+private:
+
+	// tell every running kernel to leave its loop with the given command, and join it
+	void signal(const std::string & command);
+
+	std::vector<std::unique_ptr<Interpreter>> kernels;
+	std::vector<std::thread> threads;
+
+	MessageQueue<Message> * inputQ;
+};
+
+#endif
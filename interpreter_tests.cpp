@@ -4,10 +4,17 @@
 #include <sstream>
 #include <fstream>
 #include <iostream>
+#include <cmath>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 #include "semantic_error.hpp"
 #include "interpreter.hpp"
+#include "interpreter_pool.hpp"
 #include "expression.hpp"
+#include "environment.hpp"
+#include "parse.hpp"
 
 Expression run(const std::string & program){
   
@@ -322,3 +329,1056 @@ TEST_CASE( "Test using number as procedure", "[interpreter]" ) {
   
   REQUIRE_THROWS_AS(interp.evaluate(), SemanticError);
 }
+
+TEST_CASE( "Test linked call sites follow binding changes", "[interpreter]" ) {
+
+  {
+    INFO("Repeated calls reuse the linked procedures");
+    std::string program = "(begin (define f (lambda (x) (+ x 1))) (f 1) (f (f 2)))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(4.));
+  }
+
+  {
+    INFO("A linked built-in is re-resolved once it is shadowed");
+    std::string input = "(begin (define f (lambda (x) (+ x 1))) (f 1) (define g (lambda (+) (f +))) (g 2))";
+
+    Interpreter interp;
+    std::istringstream iss(input);
+
+    REQUIRE(interp.parseStream(iss) == true);
+    REQUIRE_THROWS_AS(interp.evaluate(), SemanticError);
+  }
+}
+
+static Expression parseProgram(const std::string & program){
+
+  std::istringstream iss(program);
+  return parse(tokenize(iss));
+}
+
+TEST_CASE( "Test call sites inside lambda bodies stay linked", "[interpreter]" ) {
+
+  Environment env;
+  parseProgram("(define f (lambda (x) (+ x 1)))").eval(env);
+  parseProgram("(define g (lambda (y) (f (f y))))").eval(env);
+
+  std::shared_ptr<Expression> f = env.get_lambda(Atom("f"));
+  REQUIRE(f != nullptr);
+  long unlinked = f.use_count();
+  unsigned long version = env.exp_version();
+
+  {
+    INFO("binding a parameter keeps the lambda stamp");
+    Environment shadow(env);
+    shadow.add_exp(Atom("y"), Expression(1.));
+    REQUIRE(shadow.exp_version() == version);
+  }
+
+  Expression call = parseProgram("(g 1)");
+  REQUIRE(call.eval(env) == Expression(3.));
+
+  {
+    INFO("both sites in the body of g link to the bound f, not to copies of it");
+    REQUIRE(f.use_count() == unlinked + 2);
+  }
+
+  {
+    INFO("later calls hit the linked sites without re-linking them");
+    REQUIRE(call.eval(env) == Expression(3.));
+    REQUIRE(parseProgram("(g 5)").eval(env) == Expression(7.));
+    REQUIRE(f.use_count() == unlinked + 2);
+    REQUIRE(env.exp_version() == version);
+  }
+
+  {
+    INFO("pmap workers link their own copies of global lambdas");
+    std::string program = "(begin (define f (lambda (x) (+ x 1))) (define g (lambda (y) (f (f y)))) ";
+    REQUIRE(run(program + "(pmap g (range 0 500 1)))") == run(program + "(map g (range 0 500 1)))"));
+  }
+}
+
+TEST_CASE( "Test kernel reset restores the startup environment", "[interpreter]" ) {
+
+  MessageQueue<Message> inputQ;
+  MessageQueue<Message> outputQ;
+  Interpreter interp(&inputQ, &outputQ);
+  Message result;
+
+  // the kernel loop returns after %reset and %stop
+  inputQ.push(Message(Message::Type::StringType, "(define a 1)"));
+  inputQ.push(Message(Message::Type::StringType, "%reset"));
+  interp.threadEvalLoop();
+
+  outputQ.wait_and_pop(result);
+  REQUIRE(result.getExp() == Expression(1.));
+
+  inputQ.push(Message(Message::Type::StringType, "(a)"));
+  inputQ.push(Message(Message::Type::StringType, "(first (make-point 1 2))"));
+  inputQ.push(Message(Message::Type::StringType, "(define a 2)"));
+  inputQ.push(Message(Message::Type::StringType, "(define a 3)"));
+  inputQ.push(Message(Message::Type::StringType, "%stop"));
+  interp.threadEvalLoop();
+
+  outputQ.wait_and_pop(result);
+  REQUIRE(result.isError());
+
+  outputQ.wait_and_pop(result);
+  REQUIRE(result.getExp() == Expression(1.));
+
+  outputQ.wait_and_pop(result);
+  REQUIRE(result.getExp() == Expression(2.));
+
+  outputQ.wait_and_pop(result);
+  REQUIRE(result.isError());
+}
+
+TEST_CASE( "Test graphic primitive constructors", "[interpreter]" ) {
+
+  {
+    std::string program = "(make-point 1 2)";
+    Expression result = run(program);
+    REQUIRE(result == Expression(Expression::List{ Expression(1.), Expression(2.) }));
+    REQUIRE(result.isPointG());
+  }
+
+  {
+    std::string program = "(make-line (make-point 0 0) (make-point 1 1))";
+    Expression result = run(program);
+    REQUIRE(result.isLineG());
+    REQUIRE(result.asList()[0].isPointG());
+  }
+
+  {
+    std::string program = "(make-text \"hello\")";
+    Expression result = run(program);
+    REQUIRE(result == Expression(Atom("\"hello\"")));
+    REQUIRE(result.isTextG());
+  }
+
+  {
+    std::string program = "(get-property \"object-name\" (make-line 1 2))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(Atom("\"line\"")));
+  }
+
+  std::vector<std::string> programs = {"(make-point 1)", "(make-line 1 2 3)", "(make-text)"};
+  for(auto s : programs){
+    Interpreter interp;
+    std::istringstream iss(s);
+
+    REQUIRE(interp.parseStream(iss) == true);
+    REQUIRE_THROWS_AS(interp.evaluate(), SemanticError);
+  }
+}
+
+TEST_CASE( "Test graphic primitives made from list views", "[interpreter]" ) {
+
+  {
+    INFO("a point whose coordinates are a range or a rest slice");
+    Expression range = run("(set-property \"object-name\" \"point\" (range 3 4 1))");
+    REQUIRE(range.isPointG());
+    Expression::PointG point;
+    REQUIRE(range.asPointG(point));
+    REQUIRE(point.x == 3.);
+    REQUIRE(point.y == 4.);
+
+    Expression rest = run("(set-property \"object-name\" \"point\" (rest (list 0 5 6)))");
+    REQUIRE(rest.isPointG());
+    REQUIRE(rest.asPointG(point));
+    REQUIRE(point.x == 5.);
+    REQUIRE(point.y == 6.);
+
+    REQUIRE(!run("(set-property \"object-name\" \"point\" (range 3 5 1))").isPointG());
+  }
+
+  {
+    INFO("a line whose end points are slices");
+    Expression line = run("(make-line (rest (list 0 1 2)) (append (rest (list 0 3)) 4))");
+    REQUIRE(line.isLineG());
+    Expression::LineG lineG;
+    REQUIRE(line.asLineG(lineG));
+    REQUIRE(lineG.x1 == 1.);
+    REQUIRE(lineG.y1 == 2.);
+    REQUIRE(lineG.x2 == 3.);
+    REQUIRE(lineG.y2 == 4.);
+
+    Expression sliced = run("(set-property \"object-name\" \"line\" (rest (list 0 (range 1 2 1) (range 3 4 1))))");
+    REQUIRE(sliced.isLineG());
+    REQUIRE(sliced.asLineG(lineG));
+    REQUIRE(lineG.x1 == 1.);
+    REQUIRE(lineG.y2 == 4.);
+  }
+
+  {
+    INFO("a point cloud whose coordinates are a range");
+    Expression cloud = run("(set-property \"object-name\" \"point-cloud\" (range 1 4 1))");
+    Expression::PointCloudG cloudG;
+    REQUIRE(cloud.asPointCloudG(cloudG));
+    REQUIRE(cloudG.xs == std::vector<double>({1., 3.}));
+    REQUIRE(cloudG.ys == std::vector<double>({2., 4.}));
+  }
+}
+
+TEST_CASE( "Test element-wise arithmetic over lists", "[interpreter]" ) {
+
+  Expression::List expected = { Expression(2.), Expression(4.), Expression(6.) };
+
+  std::vector<std::string> programs = {"(+ (list 1 2 3) (list 1 2 3))",
+                                       "(* 2 (list 1 2 3))",
+                                       "(- (list 3 6 9) (list 1 2 3))",
+                                       "(/ (list 4 8 12) 2)",
+                                       "(- (list -2 -4 -6))",
+                                       "(+ 1 (list 0 2 4) 1)"};
+  for(auto s : programs){
+    INFO(s);
+    Expression result = run(s);
+    REQUIRE(result == Expression(expected));
+  }
+
+  {
+    std::string program = "(/ (list 2 4))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(Expression::List{ Expression(0.5), Expression(0.25) }));
+  }
+
+  {
+    INFO("Only elements touched by a Complex value become Complex");
+    std::string program = "(* (list 1 I) (list 2 2))";
+    Expression result = run(program);
+    Expression::List items = result.asList();
+    REQUIRE(items[0] == Expression(2.));
+    REQUIRE(items[1] == Expression(std::complex<double>(0., 2.)));
+  }
+
+  std::vector<std::string> errors = {"(+ (list 1 2) (list 1 2 3))",
+                                     "(* (list 1 (list 2)) 2)",
+                                     "(- (list \"a\") 1)",
+                                     "(/ 1 (list 1 2) 3)"};
+  for(auto s : errors){
+    Interpreter interp;
+    std::istringstream iss(s);
+
+    REQUIRE(interp.parseStream(iss) == true);
+    REQUIRE_THROWS_AS(interp.evaluate(), SemanticError);
+  }
+}
+
+TEST_CASE( "Test element-wise transcendental procedures", "[interpreter]" ) {
+
+  {
+    std::string program = "(sqrt (list 4 -4))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(Expression::List{ Expression(2.), Expression(std::complex<double>(0., 2.)) }));
+  }
+
+  {
+    std::string program = "(^ (list 1 2 3) 2)";
+    Expression result = run(program);
+    REQUIRE(result == Expression(Expression::List{ Expression(1.), Expression(4.), Expression(9.) }));
+  }
+
+  {
+    std::string program = "(^ 2 (list 1 2 3))";
+    Expression result = run(program);
+    REQUIRE(result == Expression(Expression::List{ Expression(2.), Expression(4.), Expression(8.) }));
+  }
+
+  {
+    std::string program = "(map sin (list 0 1))";
+    Expression result = run(program);
+    REQUIRE(run("(sin (list 0 1))") == result);
+    REQUIRE(run("(cos (list 0 1))") == run("(map cos (list 0 1))"));
+    REQUIRE(run("(tan (list 0 1))") == run("(map tan (list 0 1))"));
+    REQUIRE(run("(ln (list 1 2))") == run("(map ln (list 1 2))"));
+  }
+
+  std::vector<std::string> errors = {"(ln (list 1 -1))",
+                                     "(sin (list 0 I))",
+                                     "(cos (list \"a\"))",
+                                     "(tan (list (list 0)))",
+                                     "(^ (list -1 2) 2)",
+                                     "(^ (list 1 2) (list 1 2 3))"};
+  for(auto s : errors){
+    INFO(s);
+    Interpreter interp;
+    std::istringstream iss(s);
+
+    REQUIRE(interp.parseStream(iss) == true);
+    REQUIRE_THROWS_AS(interp.evaluate(), SemanticError);
+  }
+}
+
+TEST_CASE( "Test lazy range", "[interpreter]" ) {
+
+  {
+    std::string program = "(range 0 1 0.25)";
+    Expression result = run(program);
+    REQUIRE(result.isLazyRange());
+    REQUIRE(result.listSize() == 5);
+    REQUIRE(result.listAt(4) == Expression(1.));
+  }
+
+  {
+    INFO("ranges have as many entries as stepping from low while not past high gives");
+    std::vector<std::vector<double>> spans = {{0, 0.3, 0.1}, {0, 0.99999999999, 1}, {0, 1, 0.1},
+                                              {0, 1.0000000001, 1}, {-1, 0.2, 0.4}, {0, 2.9999999999999996, 1},
+                                              {0.1, 0.7, 0.2}, {1, 2, 1e-3}};
+    for(auto & span : spans){
+      std::size_t expected = 0;
+      for(double x = span[0]; x <= span[1]; x += span[2]) expected++;
+
+      std::ostringstream program;
+      program << std::setprecision(17) << "(range " << span[0] << " " << span[1] << " " << span[2] << ")";
+      INFO(program.str());
+      Expression result = run(program.str());
+      REQUIRE(result.listSize() == expected);
+      REQUIRE(result.listAt(expected - 1).head().asNumber() <= span[1]);
+    }
+  }
+
+  {
+    std::ostringstream lazy, list;
+    lazy << run("(range -1 1 1)");
+    list << run("(list -1 0 1)");
+    REQUIRE(lazy.str() == list.str());
+  }
+
+  {
+    INFO("consumers read a range without materializing it");
+    REQUIRE(run("(length (range 0 10000000 1))") == Expression(10000001.));
+    REQUIRE(run("(first (range 5 10 1))") == Expression(5.));
+    REQUIRE(run("(apply + (range 1 4 1))") == Expression(10.));
+    REQUIRE(run("(map sqrt (range 0 4 4))") == Expression(Expression::List{ Expression(0.), Expression(2.) }));
+    REQUIRE(run("(begin (define f (lambda (x) (length x))) (f (range 1 4 1)))") == Expression(4.));
+  }
+
+  {
+    INFO("list procedures still see ordinary entries");
+    REQUIRE(run("(rest (range 1 3 1))") == Expression(Expression::List{ Expression(2.), Expression(3.) }));
+    REQUIRE(run("(append (range 1 2 1) 3)") == run("(list 1 2 3)"));
+    REQUIRE(run("(join (range 1 2 1) (range 3 3.5 1))") == run("(list 1 2 3)"));
+    REQUIRE(run("(* 2 (range 1 3 1))") == run("(list 2 4 6)"));
+  }
+
+  {
+    Interpreter interp;
+    std::istringstream iss("(range 0 1e300 1e-300)");
+    REQUIRE(interp.parseStream(iss) == true);
+    REQUIRE_THROWS_AS(interp.evaluate(), SemanticError);
+  }
+}
+
+TEST_CASE( "Test map and apply on evaluated arguments", "[interpreter]" ) {
+
+  {
+    INFO("built-in procedures");
+    REQUIRE(run("(apply + (list 1 2 3))") == Expression(6.));
+    REQUIRE(run("(map - (list 1 2))") == run("(list -1 -2)"));
+  }
+
+  {
+    INFO("user-defined procedures");
+    REQUIRE(run("(begin (define f (lambda (x y) (+ x y))) (apply f (list 1 2)))") == Expression(3.));
+    REQUIRE(run("(begin (define f (lambda (x) (list x x))) (map f (list 1 2)))")
+            == run("(list (list 1 1) (list 2 2))"));
+  }
+
+  {
+    INFO("argument values are bound as-is, not evaluated again");
+    REQUIRE(run("(begin (define f (lambda (x) (first x))) (map f (list (list 1 2) (list 3))))")
+            == run("(list 1 3)"));
+    REQUIRE(run("(begin (define f (lambda (x) (get-property \"k\" x))) (f (set-property \"k\" 7 (list))))")
+            == Expression(7.));
+  }
+
+  {
+    INFO("special-form procedures still work");
+    REQUIRE(run("(get-property \"k\" (apply set-property (list \"k\" 1 (list))))") == Expression(1.));
+  }
+
+  std::vector<std::string> errors = {"(begin (define f (lambda (x y) x)) (map f (list 1 2)))",
+                                     "(begin (define f (lambda (begin) begin)) (f 1))",
+                                     "(apply first (list))"};
+  for(auto s : errors){
+    INFO(s);
+    Interpreter interp;
+    std::istringstream iss(s);
+
+    REQUIRE(interp.parseStream(iss) == true);
+    REQUIRE_THROWS_AS(interp.evaluate(), SemanticError);
+  }
+}
+
+TEST_CASE( "Test pmap matches map", "[interpreter]" ) {
+
+  std::vector<std::string> procedures = {"sqrt", "f", "g"};
+  std::string defs = "(define f (lambda (x) (* x x))) (define g (lambda (x) (pmap f (list x 1))))";
+
+  for(auto & p : procedures){
+    INFO(p);
+    Expression sequential = run("(begin " + defs + " (map " + p + " (range -50 50 1)))");
+    Expression parallel = run("(begin " + defs + " (pmap " + p + " (range -50 50 1)))");
+    REQUIRE(parallel == sequential);
+  }
+
+  {
+    INFO("the error from the first failing entry is reported");
+    std::string program = "(begin (define f (lambda (x) (first x))) (pmap f (list (list 1) 2 (list) 3)))";
+    Interpreter interp;
+    std::istringstream iss(program);
+    REQUIRE(interp.parseStream(iss) == true);
+    REQUIRE_THROWS_WITH(interp.evaluate(), "Error: argument to first is not a list");
+  }
+
+  {
+    Interpreter interp;
+    std::istringstream iss("(begin (define pmap 1))");
+    REQUIRE(interp.parseStream(iss) == true);
+    REQUIRE_THROWS_AS(interp.evaluate(), SemanticError);
+  }
+}
+
+TEST_CASE( "Test reduce and fold", "[interpreter]" ) {
+
+  REQUIRE(run("(min 3 1 2)") == Expression(1.));
+  REQUIRE(run("(max 3 1 2)") == Expression(3.));
+
+  {
+    INFO("native reductions match calling the procedure entry by entry");
+    std::string defs = "(define add (lambda (a b) (+ a b))) (define mul (lambda (a b) (* a b)))"
+                       "(define lo (lambda (a b) (min a b))) (define hi (lambda (a b) (max a b)))";
+    std::vector<std::pair<std::string, std::string>> pairs = {{"+", "add"}, {"*", "mul"}, {"min", "lo"}, {"max", "hi"}};
+    for(auto & p : pairs){
+      INFO(p.first);
+      std::string data = "(list 4 -2 7 1 3)";
+      REQUIRE(run("(begin " + defs + " (reduce " + p.first + " " + data + "))")
+              == run("(begin " + defs + " (reduce " + p.second + " " + data + "))"));
+      REQUIRE(run("(begin " + defs + " (fold " + p.first + " 5 " + data + "))")
+              == run("(begin " + defs + " (fold " + p.second + " 5 " + data + "))"));
+    }
+  }
+
+  REQUIRE(run("(reduce + (range 1 100000 1))") == Expression(5000050000.));
+  REQUIRE(run("(reduce + (list 1 I))") == Expression(std::complex<double>(1., 1.)));
+  REQUIRE(run("(reduce * (list 2 I))") == Expression(std::complex<double>(0., 2.)));
+  REQUIRE(run("(reduce + (list (list 1 2) (list 3 4)))") == run("(list 4 6)"));
+  REQUIRE(run("(reduce - (list 10 1 2))") == Expression(7.));
+  REQUIRE(run("(reduce max (list \"a\"))") == Expression(Atom("\"a\"")));
+  REQUIRE(run("(fold + 1 (list))") == Expression(1.));
+  REQUIRE(run("(begin (define f (lambda (acc x) (append acc x))) (fold f (list) (list 1 2)))") == run("(list 1 2)"));
+
+  std::vector<std::string> errors = {"(reduce + (list))",
+                                     "(reduce + 1)",
+                                     "(reduce 1 (list 1))",
+                                     "(reduce max (list 1 I))",
+                                     "(fold + (list 1))",
+                                     "(min)",
+                                     "(max \"a\")"};
+  for(auto s : errors){
+    INFO(s);
+    Interpreter interp;
+    std::istringstream iss(s);
+
+    REQUIRE(interp.parseStream(iss) == true);
+    REQUIRE_THROWS_AS(interp.evaluate(), SemanticError);
+  }
+}
+
+TEST_CASE( "Test persistent List procedures", "[interpreter]" ) {
+
+  REQUIRE(run("(begin (define a (list 1 2 3)) (define b (rest a)) (define c (append b 4)) (define d (append b 5)) (list a b c d))")
+          == run("(list (list 1 2 3) (list 2 3) (list 2 3 4) (list 2 3 5))"));
+
+  REQUIRE(run("(begin (define f (lambda (acc x) (append acc x))) (fold f (list) (range 1 5 1)))")
+          == run("(range 1 5 1)"));
+
+  REQUIRE(run("(join (rest (list 1 2)) (rest (range 0 2 1)))") == run("(list 2 1 2)"));
+  REQUIRE(run("(first (rest (rest (list 1 2 3))))") == Expression(3.));
+  REQUIRE(run("(length (rest (range 0 9 1)))") == Expression(9.));
+  REQUIRE(run("(+ 1 (append (rest (list 0 1)) 2))") == run("(list 2 3)"));
+  REQUIRE(run("(get-property \"k\" (set-property \"k\" 1 (rest (list 0 1))))") == Expression(1.));
+}
+
+TEST_CASE( "Test kernel results carry the request id", "[interpreter]" ) {
+
+  MessageQueue<Message> inputQ;
+  MessageQueue<Message> outputQ;
+  Interpreter interp(&inputQ, &outputQ);
+  Message request(Message::Type::StringType, "(+ 1 2)");
+  Message result;
+
+  request.setRequestId(42);
+  inputQ.push(request);
+  inputQ.push(Message(Message::Type::StringType, "(+ 1 \"a\")"));
+  inputQ.push(Message(Message::Type::StringType, "%stop"));
+  interp.threadEvalLoop();
+
+  outputQ.wait_and_pop(result);
+  REQUIRE(result.getRequestId() == 42);
+  REQUIRE(result.getExp() == Expression(3.));
+
+  outputQ.wait_and_pop(result);
+  REQUIRE(result.getRequestId() == 0);
+  REQUIRE(result.isError());
+}
+
+TEST_CASE( "Test pipelined submission", "[interpreter]" ) {
+
+  MessageQueue<Message> inputQ;
+  MessageQueue<Message> outputQ;
+  Interpreter interp(&inputQ, &outputQ);
+  std::thread kernel(&Interpreter::threadEvalLoop, std::ref(interp));
+
+  {
+    INFO("every program is queued before any result is read");
+    std::vector<unsigned long> ids;
+    ids.push_back(interp.submit("(define a 0)"));
+    for(int i = 1; i <= 50; i++){
+      ids.push_back(interp.submit("(+ a " + std::to_string(i) + ")"));
+    }
+    ids.push_back(interp.submit("(a b)"));
+
+    for(std::size_t i = 0; i < ids.size(); i++){
+      REQUIRE(ids[i] == i + 1);
+    }
+
+    INFO("results arrive in submission order, tagged with their ids");
+    for(std::size_t i = 0; i + 1 < ids.size(); i++){
+      Message result = outputQ.wait_and_pop();
+      REQUIRE(result.getRequestId() == ids[i]);
+      REQUIRE(result.getExp() == Expression(double(i)));
+    }
+    Message result = outputQ.wait_and_pop();
+    REQUIRE(result.getRequestId() == ids.back());
+    REQUIRE(result.isError());
+  }
+
+  REQUIRE(interp.submit("(a)") == 53);
+  REQUIRE(outputQ.wait_and_pop().getExp() == Expression(0.));
+
+  inputQ.push(Message(Message::Type::StringType, "%stop"));
+  kernel.join();
+  REQUIRE(inputQ.empty());
+  REQUIRE(outputQ.empty());
+}
+
+TEST_CASE( "Test kernel over single-producer channels", "[interpreter]" ) {
+
+  SpscQueue<Message> inputQ(8);
+  SpscQueue<Message> outputQ(8);
+  Interpreter interp(&inputQ, &outputQ);
+  std::thread kernel(&Interpreter::threadEvalLoop, std::ref(interp));
+
+  INFO("more requests than the channels hold, read while they are sent");
+  const unsigned long requests = 100;
+  std::thread reader([&](){
+    for(unsigned long id = 1; id <= requests; id++){
+      Message result;
+      outputQ.wait_and_pop(result);
+      REQUIRE(result.getRequestId() == id);
+      REQUIRE(result.getExp() == Expression(double(id)));
+    }
+  });
+  for(unsigned long id = 1; id <= requests; id++){
+    REQUIRE(interp.submit("(+ 0 " + std::to_string(id) + ")") == id);
+  }
+  reader.join();
+
+  inputQ.push(Message(Message::Type::StringType, "%stop"));
+  kernel.join();
+  REQUIRE(inputQ.empty());
+  REQUIRE(outputQ.empty());
+}
+
+TEST_CASE( "Test interpreter pool", "[interpreter]" ) {
+
+  MessageQueue<Message> inputQ;
+  MessageQueue<Message> outputQ;
+  InterpreterPool pool(4, &inputQ, &outputQ);
+  REQUIRE(pool.size() == 4);
+  REQUIRE(!pool.isRunning());
+
+  const unsigned long requests = 100;
+  for(unsigned long id = 1; id <= requests; id++){
+    std::ostringstream program;
+    program << "(begin (define a" << id << " " << id << ") (sum (range 0 a" << id << " 1)))";
+    Message request(Message::Type::StringType, program.str());
+    request.setRequestId(id);
+    inputQ.push(request);
+  }
+
+  pool.start();
+  pool.start();
+  REQUIRE(pool.isRunning());
+
+  {
+    INFO("every request is answered once, matched to its result by id");
+    std::vector<bool> seen(requests + 1, false);
+    for(unsigned long i = 0; i < requests; i++){
+      Message result;
+      outputQ.wait_and_pop(result);
+      unsigned long id = result.getRequestId();
+      REQUIRE(id >= 1);
+      REQUIRE(id <= requests);
+      REQUIRE(!seen[id]);
+      seen[id] = true;
+      REQUIRE(result.getExp() == Expression(id * (id + 1) / 2.));
+    }
+  }
+
+  {
+    INFO("after a reset no kernel keeps a definition");
+    pool.reset();
+    REQUIRE(pool.isRunning());
+    for(unsigned long id = 1; id <= 8; id++){
+      std::ostringstream program;
+      program << "(a" << id << ")";
+      Message request(Message::Type::StringType, program.str());
+      request.setRequestId(id);
+      inputQ.push(request);
+    }
+    for(unsigned long i = 0; i < 8; i++){
+      Message result;
+      outputQ.wait_and_pop(result);
+      REQUIRE(result.isError());
+    }
+  }
+
+  pool.stop();
+  REQUIRE(!pool.isRunning());
+  REQUIRE(inputQ.empty());
+  REQUIRE(outputQ.empty());
+}
+
+// Evaluate program on another thread, interrupting it until it finishes;
+// returns the error it stopped with, or "" if it completed
+static std::string interrupted(Interpreter & interp, const std::string & program){
+
+  std::istringstream iss(program);
+  REQUIRE(interp.parseStream(iss));
+
+  std::atomic<bool> done(false);
+  std::string error;
+  std::thread kernel([&](){
+    try{
+      interp.evaluate();
+    }
+    catch(const SemanticError & ex){
+      error = ex.what();
+    }
+    done = true;
+  });
+
+  // interrupt more than once, in case the first arrives before evaluation starts
+  while(!done){
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    interp.interrupt();
+  }
+  kernel.join();
+
+  return error;
+}
+
+TEST_CASE( "Test interrupting an evaluation", "[interpreter]" ) {
+
+  Interpreter interp;
+  interp.reset();
+
+  std::string program = "(begin (define f (lambda (x) (sum (range 0 (+ x 1) 1)))) ";
+
+  {
+    INFO("map over a lambda stops at the next element");
+    std::string error = interrupted(interp, program + "(define big (map f (range 0 1000000 1))))");
+    REQUIRE(error == "Error: interpreter kernel interrupted");
+  }
+
+  {
+    INFO("pmap stops every chunk and reports the interrupt");
+    std::string error = interrupted(interp, "(pmap f (range 0 1000000 1))");
+    REQUIRE(error == "Error: interpreter kernel interrupted");
+  }
+
+  {
+    INFO("reduce stops between calls");
+    std::string error = interrupted(interp, "(reduce + (map f (range 0 1000000 1)))");
+    REQUIRE(error == "Error: interpreter kernel interrupted");
+  }
+
+  {
+    INFO("long built-ins stop between blocks of their data");
+    REQUIRE(interrupted(interp, "(fft (range 0 1000000 1))") == "Error: interpreter kernel interrupted");
+    REQUIRE(interrupted(interp, "(+ (range 0 1000000 1) 1)") == "Error: interpreter kernel interrupted");
+  }
+
+  {
+    INFO("an interrupted define is not made and the next evaluation runs");
+    std::istringstream iss("(f 4)");
+    REQUIRE(interp.parseStream(iss));
+    REQUIRE(interp.evaluate() == Expression(15.));
+
+    std::istringstream undefined("(big)");
+    REQUIRE(interp.parseStream(undefined));
+    REQUIRE_THROWS_AS(interp.evaluate(), SemanticError);
+  }
+
+  {
+    INFO("an interrupt sent between evaluations does not stop the next one");
+    interp.interrupt();
+    std::istringstream iss("(map f (list 1 2 3))");
+    REQUIRE(interp.parseStream(iss));
+    REQUIRE(interp.evaluate() == run("(list 3 6 10)"));
+  }
+}
+
+TEST_CASE( "Test interrupting queued submissions", "[interpreter]" ) {
+
+  SpscQueue<Message> inputQ(8);
+  SpscQueue<Message> outputQ(8);
+  Interpreter interp(&inputQ, &outputQ);
+  std::thread kernel(&Interpreter::threadEvalLoop, std::ref(interp));
+
+  {
+    INFO("programs queued behind the running one are cancelled with it");
+    interp.submit("(define big (map (lambda (x) (+ x 1)) (range 0 1000000 1)))");
+    interp.submit("(define a 1)");
+    interp.submit("(+ 1 2)");
+    interp.submit("(a)");
+    interp.interrupt();
+
+    for(unsigned long id = 1; id <= 4; id++){
+      Message result;
+      outputQ.wait_and_pop(result);
+      REQUIRE(result.getRequestId() == id);
+      REQUIRE(result == Message(Message::Type::ErrorType, "Error: interpreter kernel interrupted"));
+    }
+  }
+
+  {
+    INFO("programs submitted after the interrupt run");
+    REQUIRE(interp.submit("(+ 1 2)") == 5);
+    Message result;
+    outputQ.wait_and_pop(result);
+    REQUIRE(result.getRequestId() == 5);
+    REQUIRE(result.getExp() == Expression(3.));
+  }
+
+  inputQ.push(Message(Message::Type::StringType, "%stop"));
+  kernel.join();
+  REQUIRE(inputQ.empty());
+  REQUIRE(outputQ.empty());
+}
+
+TEST_CASE( "Test statistics procedures", "[interpreter]" ) {
+
+  REQUIRE(run("(sum (list 1 2 3 4))") == Expression(10.));
+  REQUIRE(run("(sum (list 1 I))") == Expression(std::complex<double>(1., 1.)));
+  REQUIRE(run("(mean (list 1 2 3 4))") == Expression(2.5));
+  REQUIRE(run("(stddev (list 2 4 4 4 5 5 7 9))") == Expression(2.));
+  REQUIRE(run("(minmax (list 3 -1 7 2))") == run("(list -1 7)"));
+  REQUIRE(run("(quantiles (list 4 1 3 2 5) (list 0 0.5 1 0.125))") == run("(list 1 3 5 1.5)"));
+  REQUIRE(run("(histogram (list 0 1 1 2 3 4) 2)") == run("(list (list 1 3) (list 3 3))"));
+  REQUIRE(run("(histogram (list 5 5) 1)") == run("(list (list 5 2))"));
+
+  {
+    INFO("large inputs match the sequential definitions");
+    REQUIRE(run("(sum (range 1 100000 1))") == Expression(5000050000.));
+    Expression sd = run("(stddev (range 1 100000 1))");
+    REQUIRE(sd.head().asNumber() == Approx(std::sqrt((100000. * 100000. - 1) / 12)));
+    REQUIRE(run("(length (histogram (range 0 99999 1) 10))") == Expression(10.));
+    REQUIRE(run("(first (rest (first (histogram (range 0 99999 1) 10))))") == Expression(10000.));
+  }
+
+  REQUIRE(run("(discrete-plot (histogram (list 1 2 2 3) 3) (list))").isHeadList());
+
+  std::vector<std::string> errors = {"(sum)",
+                                     "(sum 1)",
+                                     "(sum (list))",
+                                     "(mean (list \"a\"))",
+                                     "(stddev (list 1 I))",
+                                     "(minmax (list 1) 2)",
+                                     "(quantiles (list 1 2) 0.5)",
+                                     "(quantiles (list 1 2) (list 2))",
+                                     "(quantiles (list 1 (/ 0 0) 2 3) (list 0.5))",
+                                     "(quantiles (list 1 (/ 1 0)) (list 0.5))",
+                                     "(histogram (list 1 2) 0)",
+                                     "(histogram (list 1 2) 1.5)",
+                                     "(histogram (list 1 (/ 1 0)) 2)",
+                                     "(histogram (list (ln 0) 1) 2)",
+                                     "(histogram (list 1 (- (/ 1 0) (/ 1 0)) 2) 2)"};
+  for(auto s : errors){
+    INFO(s);
+    Interpreter interp;
+    std::istringstream iss(s);
+
+    REQUIRE(interp.parseStream(iss) == true);
+    REQUIRE_THROWS_AS(interp.evaluate(), SemanticError);
+  }
+}
+
+TEST_CASE( "Test signal processing procedures", "[interpreter]" ) {
+
+  REQUIRE(run("(fft (list 1 1 1 1))") == run("(list (+ 4 (* 0 I)) (* 0 I) (* 0 I) (* 0 I))"));
+  REQUIRE(run("(real (first (ifft (fft (list 3 1 4)))))").head().asNumber() == Approx(3.));
+  REQUIRE(run("(length (fft (range 1 100 1)))") == Expression(100.));
+  REQUIRE(run("(convolve (list 1 2 3) (list 0 1 0.5))") == run("(list 0 1 2.5 4 1.5)"));
+  REQUIRE(run("(moving-average (list 1 2 3 4 5) 3)") == run("(list 2 3 4)"));
+  REQUIRE(run("(length (moving-average (range 1 1000 1) 10))") == Expression(991.));
+
+  REQUIRE(run("(begin (define f (lambda (x) (list x x))) (discrete-plot (map f (moving-average (list 1 2 3) 2)) (list)))").isHeadList());
+
+  std::vector<std::string> errors = {"(fft)",
+                                     "(fft (list))",
+                                     "(ifft 1)",
+                                     "(convolve (list 1))",
+                                     "(convolve (list 1) 2)",
+                                     "(convolve (list 1) (list \"a\"))",
+                                     "(moving-average (list 1 2) 0)",
+                                     "(moving-average (list 1 2) 3)",
+                                     "(moving-average (list 1 2) 1.5)"};
+  for(auto s : errors){
+    INFO(s);
+    Interpreter interp;
+    std::istringstream iss(s);
+
+    REQUIRE(interp.parseStream(iss) == true);
+    REQUIRE_THROWS_AS(interp.evaluate(), SemanticError);
+  }
+}
+
+TEST_CASE( "Test matrix procedures", "[interpreter]" ) {
+
+  REQUIRE(run("(matrix-to-list (matrix (list (list 1 2) (list 3 4))))") == run("(list (list 1 2) (list 3 4))"));
+  REQUIRE(run("(matrix (list (list 1 2) (list 3 4)))").isHeadMatrix());
+  REQUIRE(run("(matrix (list (list 1 2)))") == run("(matrix (list (list 1 2)))"));
+  REQUIRE(run("(matrix (list (list 1 2)))") != run("(matrix (list (list 1) (list 2)))"));
+  REQUIRE(run("(matrix (list (list 1 2)))") != run("(list (list 1 2))"));
+
+  REQUIRE(run("(matrix-to-list (matmul (matrix (list (list 1 2) (list 3 4))) (matrix (list (list 5) (list 6)))))")
+          == run("(list (list 17) (list 39))"));
+  REQUIRE(run("(matrix-to-list (transpose (matrix (list (list 1 2 3)))))") == run("(list (list 1) (list 2) (list 3))"));
+  REQUIRE(run("(row-sums (matrix (list (list 1 2) (list 3 4))))") == run("(list 3 7)"));
+  REQUIRE(run("(column-sums (matrix (list (list 1 2) (list 3 4))))") == run("(list 4 6)"));
+
+  {
+    INFO("arithmetic is element-wise, with Numbers broadcast over every entry");
+    REQUIRE(run("(begin (define m (matrix (list (list 1 2) (list 3 4)))) (matrix-to-list (+ m m 1)))")
+            == run("(list (list 3 5) (list 7 9))"));
+    REQUIRE(run("(begin (define m (matrix (list (list 1 2) (list 3 4)))) (matrix-to-list (* 2 m m)))")
+            == run("(list (list 2 8) (list 18 32))"));
+    REQUIRE(run("(matrix-to-list (- 10 (matrix (list (list 1 2)))))") == run("(list (list 9 8))"));
+    REQUIRE(run("(matrix-to-list (- (matrix (list (list 1 2)))))") == run("(list (list -1 -2))"));
+    REQUIRE(run("(matrix-to-list (/ (matrix (list (list 1 4)))))") == run("(list (list 1 0.25))"));
+    REQUIRE(run("(matrix-to-list (/ (matrix (list (list 1 4))) 2))") == run("(list (list 0.5 2))"));
+  }
+
+  {
+    INFO("a Matrix prints as its List of rows");
+    std::ostringstream printed, expected;
+    printed << run("(matrix (list (list 1 2) (list 3 4)))");
+    expected << run("(list (list 1 2) (list 3 4))");
+    REQUIRE(printed.str() == expected.str());
+  }
+
+  std::vector<std::string> errors = {"(matrix)",
+                                     "(matrix 1)",
+                                     "(matrix (list 1 2))",
+                                     "(matrix (list (list 1) (list 1 2)))",
+                                     "(matrix-to-list (list 1))",
+                                     "(matmul (matrix (list (list 1 2))) (matrix (list (list 1 2))))",
+                                     "(matmul (matrix (list (list 1))))",
+                                     "(transpose (list (list 1)))",
+                                     "(row-sums 1)",
+                                     "(+ (matrix (list (list 1 2))) (matrix (list (list 1))))",
+                                     "(+ (matrix (list (list 1 2))) I)",
+                                     "(* (matrix (list (list 1 2))) (list 1 2))"};
+  for(auto s : errors){
+    INFO(s);
+    Interpreter interp;
+    std::istringstream iss(s);
+
+    REQUIRE(interp.parseStream(iss) == true);
+    REQUIRE_THROWS_AS(interp.evaluate(), SemanticError);
+  }
+}
+
+TEST_CASE( "Test continuous-plot", "[interpreter]" ) {
+
+  {
+    INFO("a straight line needs no refinement: box, axes, 50 segments, title and tick labels");
+    Expression plot = run("(begin (define f (lambda (x) (+ (* 2 x) 1))) "
+                          "(continuous-plot f (list -2 2) (list (list \"title\" \"A line\"))))");
+    REQUIRE(plot.isHeadList());
+    REQUIRE(plot.listSize() == 61);
+
+    std::size_t lines = 0;
+    for(std::size_t i = 0; i < plot.listSize(); i++){
+      if(plot.listAt(i).isLineG()) lines++;
+    }
+    REQUIRE(lines == 56);
+  }
+
+  {
+    INFO("curves are refined where they bend");
+    Expression plot = run("(begin (define f (lambda (x) (* x x))) (continuous-plot f (list -1 1)))");
+    REQUIRE(plot.listSize() > 60);
+  }
+
+  INFO("built-ins, sampled in parallel, match the equivalent lambda");
+  REQUIRE(run("(continuous-plot sin (list -10 10))")
+          == run("(begin (define f (lambda (x) (sin x))) (continuous-plot f (list -10 10)))"));
+
+  INFO("samples where the procedure is not finite break the curve");
+  REQUIRE(run("(begin (define f (lambda (x) (/ 1 x))) (continuous-plot f (list -1 1)))").isHeadList());
+
+  std::vector<std::string> errors = {"(continuous-plot sin)",
+                                     "(continuous-plot 1 (list 0 1))",
+                                     "(continuous-plot nope (list 0 1))",
+                                     "(continuous-plot sin (list 1 0))",
+                                     "(continuous-plot sin (list 0 1 2))",
+                                     "(continuous-plot sin (list 0 1) 1)",
+                                     "(continuous-plot sin (list 0 1) (list 1))",
+                                     "(begin (define f (lambda (x) (list x))) (continuous-plot f (list 0 1)))",
+                                     "(begin (define f (lambda (x) 1)) (continuous-plot f (list 0 1)))",
+                                     "(define continuous-plot 1)"};
+  for(auto s : errors){
+    INFO(s);
+    Interpreter interp;
+    std::istringstream iss(s);
+
+    REQUIRE(interp.parseStream(iss) == true);
+    REQUIRE_THROWS_AS(interp.evaluate(), SemanticError);
+  }
+}
+
+TEST_CASE( "Test discrete-plot decimation", "[interpreter]" ) {
+
+  std::string data = "(begin (define f (lambda (x) (list x (sin (/ x 10))))) (define data (map f (range 0 999 1))) ";
+
+  {
+    INFO("a plot that draws every point has no dropped-points property");
+    REQUIRE(run("(get-property \"dropped-points\" (discrete-plot (list (list 0 0) (list 1 1)) (list)))") == Expression());
+    REQUIRE(run(data + "(get-property \"dropped-points\" (discrete-plot data (list))))") == Expression());
+  }
+
+  {
+    INFO("only the extremes of each bucket are drawn once the data exceeds the budget");
+    Expression plot = run(data + "(discrete-plot data (list (list \"point-budget\" 100))))");
+    double dropped = plot.getProperty("\"dropped-points\"").head().asNumber();
+    REQUIRE(dropped >= 900);
+
+    std::size_t points = 0;
+    double yMin = 0, yMax = 0;
+    for(std::size_t i = 0; i < plot.listSize(); i++){
+      Expression item = plot.listAt(i);
+      if(item.isPointG()){
+        points++;
+        yMin = std::min(yMin, item.listAt(1).head().asNumber());
+        yMax = std::max(yMax, item.listAt(1).head().asNumber());
+      }
+    }
+    REQUIRE(points == 1000 - dropped);
+
+    // the data spans -1 to 1, scaled into the 20 unit box and negated
+    REQUIRE(yMin == Approx(-10));
+    REQUIRE(yMax == Approx(10));
+  }
+
+  {
+    INFO("a budget beyond any data draws every point");
+    std::string points = "(discrete-plot (list (list 0 0) (list 1 1) (list 2 0)) ";
+    REQUIRE(run(points + "(list (list \"point-budget\" (/ 1 0))))") == run(points + "(list))"));
+    REQUIRE(run(points + "(list (list \"point-budget\" 1e300)))") == run(points + "(list))"));
+  }
+
+  std::vector<std::string> errors = {"(discrete-plot (list (list 0 0) (list 1 1)) (list (list \"point-budget\" 1)))",
+                                     "(discrete-plot (list (list 0 0) (list 1 1)) (list (list \"point-budget\" 2.5)))",
+                                     "(discrete-plot (list (list 0 0) (list 1 1)) (list (list \"point-budget\" \"a\")))"};
+  for(auto s : errors){
+    INFO(s);
+    Interpreter interp;
+    std::istringstream iss(s);
+
+    REQUIRE(interp.parseStream(iss) == true);
+    REQUIRE_THROWS_AS(interp.evaluate(), SemanticError);
+  }
+}
+
+TEST_CASE( "Test discrete-plot reads data in place", "[interpreter]" ) {
+
+  INFO("List views are plotted exactly like the equivalent plain List");
+  REQUIRE(run("(discrete-plot (rest (list (list 9 9) (list -1 -1) (list 1 1))) (list))")
+          == run("(discrete-plot (list (list -1 -1) (list 1 1)) (list))"));
+  REQUIRE(run("(discrete-plot (list (list -1 -1) (rest (list 0 1 1))) (list))")
+          == run("(discrete-plot (list (list -1 -1) (list 1 1)) (list))"));
+
+  std::vector<std::string> errors = {"(discrete-plot (list) (list))",
+                                     "(discrete-plot (list (list 0 0)) (list))",
+                                     "(discrete-plot (list (list 0 0) (list 1)) (list))",
+                                     "(discrete-plot (list (list 0 (/ 0 0)) (list 1 1)) (list))",
+                                     "(discrete-plot (list (list 0 0) (list 1 1) (list (/ 1 0) 2)) (list))",
+                                     "(discrete-plot (list (list 0 0) (list 1 1) (list 2 \"a\")) (list))"};
+  for(auto s : errors){
+    INFO(s);
+    Interpreter interp;
+    std::istringstream iss(s);
+
+    REQUIRE(interp.parseStream(iss) == true);
+    REQUIRE_THROWS_AS(interp.evaluate(), SemanticError);
+  }
+}
+
+TEST_CASE( "Test set-property tags graphic primitives", "[interpreter]" ) {
+
+  REQUIRE(run("(set-property \"object-name\" \"point\" (list 1 2))").isPointG());
+  REQUIRE(run("(set-property \"object-name\" \"line\" (list (make-point 0 0) (make-point 1 1)))").isLineG());
+  REQUIRE(run("(set-property \"object-name\" \"text\" \"hi\")").isTextG());
+  REQUIRE(!run("(set-property \"object-name\" \"other\" (make-point 1 2))").isPointG());
+  REQUIRE(run("(get-property \"size\" (set-property \"size\" 4 (make-point 1 2)))") == Expression(4.));
+  REQUIRE(run("(get-property \"object-name\" (make-text \"a\"))") == Expression(Atom("\"text\"")));
+}
+
+TEST_CASE( "Test batched plot primitives", "[interpreter]" ) {
+
+  std::string data = "(begin (define f (lambda (x) (list x (sin (/ x 10))))) (define data (map f (range 0 999 1))) ";
+
+  {
+    INFO("a large discrete-plot is a handful of items: box, cloud, stems and labels");
+    Expression plot = run(data + "(discrete-plot data (list)))");
+    REQUIRE(plot.listSize() == 4 + 1 + 2 + 4);
+
+    Expression::PointCloudG cloud;
+    REQUIRE(plot.listAt(5).asPointCloudG(cloud));
+    REQUIRE(cloud.xs.size() == 1000);
+    REQUIRE(cloud.size == 0.5);
+    REQUIRE(cloud.xs[999] == Approx(20));
+
+    Expression::PolylineG stems;
+    REQUIRE(plot.listAt(6).asPolylineG(stems));
+    REQUIRE(stems.xs.size() == 3000);
+    REQUIRE(stems.thickness == 0);
+    REQUIRE(stems.ys[0] == 0);
+    REQUIRE(stems.ys[2] == 0);
+  }
+
+  {
+    INFO("small plots keep one item per point");
+    Expression plot = run("(discrete-plot (list (list -1 -1) (list 1 1)) (list))");
+    REQUIRE(plot.listSize() == 4 + 2 + 2 * 2 + 4);
+  }
+
+  {
+    INFO("a densely sampled continuous-plot is drawn as one Polyline per unbroken run");
+    Expression plot = run("(begin (define f (lambda (x) (/ (sin x) x))) (continuous-plot f (list -40 40)))");
+    std::size_t polylines = 0;
+    for(std::size_t i = 0; i < plot.listSize(); i++){
+      if(plot.listAt(i).isPolylineG()) polylines++;
+    }
+    REQUIRE(polylines == 2);
+  }
+
+  REQUIRE(run("(set-property \"object-name\" \"point-cloud\" (list 1 2 3 4))").isPointCloudG());
+  REQUIRE(!run("(set-property \"object-name\" \"point-cloud\" (list 1 2 3))").isPointCloudG());
+  REQUIRE(!run("(set-property \"object-name\" \"polyline\" (list 1 2))").isPolylineG());
+  REQUIRE(!run("(set-property \"object-name\" \"polyline\" (list 1 2 3 \"a\"))").isPolylineG());
+}
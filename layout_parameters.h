@@ -1,7 +1,8 @@
 #ifndef LAYOUT_PARAMETERS_H
 #define LAYOUT_PARAMETERS_H
 
-/* This structure is to be used by the discrete-plot(DATA, OPTIONS) method
+/* This structure is to be used by the discrete-plot(DATA, OPTIONS) and
+ * continuous-plot(FUNC, BOUNDS, OPTIONS) methods
  * to encapsulate the plotting parameters of each evaluated expression, and
  * to communicate the data between helper functions. */
 struct LayoutParams {
@@ -12,6 +13,8 @@ struct LayoutParams {
 	double C = 2;			// Vertical offset distance for tick labels
 	double D = 2;			// Horizontal offset distance for tick labels
 	double P = 0.5;		// Size of points
+	double budget = 4000;	// Most data points drawn, about 4x the plot width in pixels
+	double batch = 256;	// Plots of more points are drawn as batched primitives
 
 	double txtScale;
 	double xMax, yMax;	// Ordinate limits
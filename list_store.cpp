@@ -0,0 +1,81 @@
+#include "list_store.hpp"
+
+#include <new>
+
+void ListStore::FreeBlock::operator()(Expression * block) const noexcept{
+  ::operator delete(block);
+}
+
+ListStore::ListStore(): m_size(0), m_built(0){}
+
+ListStore::~ListStore(){
+
+  for(std::size_t i = 0; i < m_built; i++){
+    slot(i)->~Expression();
+  }
+}
+
+std::size_t ListStore::size() const noexcept{
+  return m_size;
+}
+
+void ListStore::locate(std::size_t i, std::size_t & block, std::size_t & pos) noexcept{
+
+  // entry i is at offset i + FIRST_BLOCK counting from the start of a
+  // (virtual) block of FIRST_BLOCK entries before block 0, so its block is
+  // given by the highest set bit of that offset
+  std::size_t offset = i + FIRST_BLOCK;
+
+#if defined(__GNUC__)
+  std::size_t high = (8 * sizeof(unsigned long long) - 1) - __builtin_clzll(offset);
+#else
+  std::size_t high = 0;
+  while(offset >> (high + 1)) high++;
+#endif
+
+  block = high - 3; // log2(FIRST_BLOCK)
+  pos = offset - (std::size_t(1) << high);
+}
+
+Expression * ListStore::slot(std::size_t i) const noexcept{
+
+  std::size_t block, pos;
+  locate(i, block, pos);
+  return m_blocks[block].get() + pos;
+}
+
+const Expression & ListStore::at(std::size_t i) const noexcept{
+  return *slot(i);
+}
+
+bool ListStore::append(std::size_t end, const std::vector<Expression> & entries){
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  if(m_size != end){
+    return false;
+  }
+
+  for(auto & entry : entries){
+    std::size_t block, pos;
+    locate(end, block, pos);
+    if(!m_blocks[block]){
+      std::size_t bytes = sizeof(Expression) * (FIRST_BLOCK << block);
+      m_blocks[block].reset(static_cast<Expression *>(::operator new(bytes)));
+    }
+
+    // reuse an entry left unpublished by an append that threw part way
+    if(end < m_built){
+      *slot(end) = entry;
+    }
+    else{
+      new (slot(end)) Expression(entry);
+      m_built++;
+    }
+    end++;
+  }
+
+  // publish the new entries only once they are all in place
+  m_size = end;
+  return true;
+}
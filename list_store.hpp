@@ -0,0 +1,80 @@
+/*! \file list_store.hpp
+Defines the append-only storage shared by List slices.
+ */
+#ifndef LIST_STORE_HPP
+#define LIST_STORE_HPP
+
+#include "expression.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*! \class ListStore
+\brief Append-only entries shared by any number of List slices.
+
+A List made by rest, append or join views the entries [offset, offset + size)
+of a store. Entries are never modified or moved once stored, so slices can
+share a store freely, even across threads. A List that ends where the store
+ends can be appended to in place; the Lists already viewing the store do not
+see the new entries because they lie past their own end.
+
+Entries live in blocks of doubling size, which are allocated as the store
+grows and never reallocated. A block is raw storage; each entry is
+constructed in place when it is appended, so a half-used block costs no
+default-constructed Expressions.
+ */
+class ListStore {
+public:
+
+  ListStore();
+
+  /// destroy every entry constructed in the blocks
+  ~ListStore();
+
+  ListStore(const ListStore &) = delete;
+  ListStore & operator=(const ListStore &) = delete;
+
+  /// number of entries stored
+  std::size_t size() const noexcept;
+
+  /// entry i, where i < size()
+  const Expression & at(std::size_t i) const noexcept;
+
+  /*! Append entries if, and only if, the store currently has end entries.
+    This is safe to call from several threads at once.
+    \param end the size the caller's slice expects the store to have
+    \param entries the entries to append
+    \return false, leaving the store unchanged, if another List has already
+    appended past end
+   */
+  bool append(std::size_t end, const std::vector<Expression> & entries);
+
+private:
+
+  // block k holds FIRST_BLOCK << k entries
+  static const std::size_t FIRST_BLOCK = 8;
+  static const std::size_t MAX_BLOCKS = 58;
+
+  // find the block and position within it holding entry i
+  static void locate(std::size_t i, std::size_t & block, std::size_t & pos) noexcept;
+
+  // the storage of entry i, constructed or not
+  Expression * slot(std::size_t i) const noexcept;
+
+  // frees the storage of a block without destroying the entries in it
+  struct FreeBlock {
+    void operator()(Expression * block) const noexcept;
+  };
+
+  std::unique_ptr<Expression, FreeBlock> m_blocks[MAX_BLOCKS];
+  std::atomic<std::size_t> m_size;
+
+  // entries constructed, at least m_size; more if an append failed part way
+  std::size_t m_built;
+  std::mutex m_mutex;
+};
+
+#endif
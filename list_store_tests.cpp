@@ -0,0 +1,29 @@
+#include "catch.hpp"
+
+#include "list_store.hpp"
+
+TEST_CASE( "Test ListStore appends", "[list_store]" )
+{
+  ListStore store;
+  REQUIRE(store.size() == 0);
+
+  std::vector<Expression> entries;
+  for(int i = 0; i < 100; i++){
+    entries.push_back(Expression(double(i)));
+  }
+
+  REQUIRE(store.append(0, entries));
+  REQUIRE(store.size() == 100);
+
+  INFO("entries keep their place as blocks are added");
+  const Expression * first = &store.at(0);
+  REQUIRE(store.append(100, entries));
+  REQUIRE(&store.at(0) == first);
+  for(std::size_t i = 0; i < store.size(); i++){
+    REQUIRE(store.at(i) == Expression(double(i % 100)));
+  }
+
+  INFO("only a List ending where the store ends may append");
+  REQUIRE(!store.append(100, entries));
+  REQUIRE(store.size() == 200);
+}
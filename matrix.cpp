@@ -0,0 +1,262 @@
+#include "matrix.hpp"
+#include "thread_pool.hpp"
+#include "cancellation.hpp"
+
+#include <algorithm>
+
+/***********************************************************************
+Kernels over contiguous rows. As in vector_ops, the __restrict qualifiers
+tell the compiler the buffers do not alias so it can vectorize the loops.
+**********************************************************************/
+
+// out[j] += a * x[j]
+static void axpy_v(double * __restrict out, double a, const double * __restrict x, std::size_t n){
+  for(std::size_t j = 0; j < n; j++) out[j] += a * x[j];
+}
+
+static void add_vv(double * __restrict out, const double * __restrict x, std::size_t n){
+  for(std::size_t j = 0; j < n; j++) out[j] += x[j];
+}
+
+static void apply_vv(double * __restrict out, const double * __restrict x, std::size_t n, MatrixOp op){
+  switch(op){
+  case MatrixOp::Add: for(std::size_t j = 0; j < n; j++) out[j] += x[j]; break;
+  case MatrixOp::Sub: for(std::size_t j = 0; j < n; j++) out[j] -= x[j]; break;
+  case MatrixOp::Mul: for(std::size_t j = 0; j < n; j++) out[j] *= x[j]; break;
+  case MatrixOp::Div: for(std::size_t j = 0; j < n; j++) out[j] /= x[j]; break;
+  }
+}
+
+static void apply_vs(double * __restrict out, double x, std::size_t n, MatrixOp op){
+  switch(op){
+  case MatrixOp::Add: for(std::size_t j = 0; j < n; j++) out[j] += x; break;
+  case MatrixOp::Sub: for(std::size_t j = 0; j < n; j++) out[j] -= x; break;
+  case MatrixOp::Mul: for(std::size_t j = 0; j < n; j++) out[j] *= x; break;
+  case MatrixOp::Div: for(std::size_t j = 0; j < n; j++) out[j] /= x; break;
+  }
+}
+
+// a tile of doubles on each side, so one tile of each of a, b and the
+// product (3 x 32 KiB) stays in a typical L2 cache
+static const std::size_t MATMUL_TILE = 64;
+
+// transposing reads rows and writes columns, so its tiles are kept small
+// enough that the columns being written stay in L1
+static const std::size_t TRANSPOSE_TILE = 32;
+
+// products with fewer multiply-adds than this run on the calling thread
+static const std::size_t PARALLEL_MATMUL = 1 << 20;
+
+/***********************************************************************
+Matrix Methods
+**********************************************************************/
+
+Matrix::Matrix(): m_rows(0), m_cols(0){}
+
+Matrix::Matrix(std::size_t rows, std::size_t cols, double fill):
+  m_rows(rows), m_cols(cols), m_data(rows * cols, fill){}
+
+std::size_t Matrix::rows() const noexcept{
+  return m_rows;
+}
+
+std::size_t Matrix::cols() const noexcept{
+  return m_cols;
+}
+
+double & Matrix::operator()(std::size_t i, std::size_t j) noexcept{
+  return m_data[i * m_cols + j];
+}
+
+double Matrix::operator()(std::size_t i, std::size_t j) const noexcept{
+  return m_data[i * m_cols + j];
+}
+
+double * Matrix::data() noexcept{
+  return m_data.data();
+}
+
+const double * Matrix::data() const noexcept{
+  return m_data.data();
+}
+
+bool Matrix::operator==(const Matrix & right) const noexcept{
+  return (m_rows == right.m_rows) && (m_cols == right.m_cols) && (m_data == right.m_data);
+}
+
+/***********************************************************************
+Conversion To and From Expressions
+**********************************************************************/
+
+bool toMatrix(const Expression & exp, Matrix & out){
+
+  if(!exp.isHeadList() || (exp.listSize() == 0)){
+    return false;
+  }
+
+  std::size_t rows = exp.listSize();
+  std::size_t cols = 0;
+
+  for(std::size_t i = 0; i < rows; i++){
+    Expression row = exp.listAt(i);
+    if(!row.isHeadList() || (row.listSize() == 0)){
+      return false;
+    }
+
+    if(i == 0){
+      cols = row.listSize();
+      out = Matrix(rows, cols);
+    }
+    else if(row.listSize() != cols){
+      return false;
+    }
+
+    for(std::size_t j = 0; j < cols; j++){
+      Expression entry = row.listAt(j);
+      if(!entry.isHeadNumber() || !entry.isTailEmpty()){
+        return false;
+      }
+      out(i, j) = entry.head().asNumber();
+    }
+  }
+
+  return true;
+}
+
+Expression fromMatrix(const Matrix & m){
+
+  Expression::List rows;
+  rows.reserve(m.rows());
+
+  for(std::size_t i = 0; i < m.rows(); i++){
+    Expression::List row;
+    row.reserve(m.cols());
+    for(std::size_t j = 0; j < m.cols(); j++){
+      row.emplace_back(Atom(m(i, j)));
+    }
+    rows.emplace_back(row);
+  }
+
+  return Expression(rows);
+}
+
+/***********************************************************************
+Linear Algebra
+**********************************************************************/
+
+Matrix transpose(const Matrix & m){
+
+  Matrix result(m.cols(), m.rows());
+
+  for(std::size_t i0 = 0; i0 < m.rows(); i0 += TRANSPOSE_TILE){
+    std::size_t i1 = std::min(i0 + TRANSPOSE_TILE, m.rows());
+    for(std::size_t j0 = 0; j0 < m.cols(); j0 += TRANSPOSE_TILE){
+      std::size_t j1 = std::min(j0 + TRANSPOSE_TILE, m.cols());
+      for(std::size_t i = i0; i < i1; i++){
+        for(std::size_t j = j0; j < j1; j++){
+          result(j, i) = m(i, j);
+        }
+      }
+    }
+  }
+
+  return result;
+}
+
+bool matmul(const Matrix & a, const Matrix & b, Matrix & out){
+
+  if(a.cols() != b.rows()){
+    return false;
+  }
+
+  std::size_t rows = a.rows();
+  std::size_t inner = a.cols();
+  std::size_t cols = b.cols();
+  Matrix result(rows, cols);
+
+  const double * A = a.data();
+  const double * B = b.data();
+  double * C = result.data();
+
+  // each band of MATMUL_TILE rows of the product is independent, so bands
+  // can be computed on separate threads without sharing any output. Once
+  // the evaluation is interrupted the remaining bands are skipped
+  const CancellationToken * token = CancellationToken::current();
+  auto bands = [=](std::size_t begin, std::size_t end){
+    for(std::size_t band = begin; band < end; band++){
+      if(token && token->isCancelled()) return;
+
+      std::size_t i0 = band * MATMUL_TILE;
+      std::size_t i1 = std::min(i0 + MATMUL_TILE, rows);
+
+      for(std::size_t k0 = 0; k0 < inner; k0 += MATMUL_TILE){
+        std::size_t k1 = std::min(k0 + MATMUL_TILE, inner);
+        for(std::size_t j0 = 0; j0 < cols; j0 += MATMUL_TILE){
+          std::size_t width = std::min(j0 + MATMUL_TILE, cols) - j0;
+
+          for(std::size_t i = i0; i < i1; i++){
+            for(std::size_t k = k0; k < k1; k++){
+              axpy_v(C + i * cols + j0, A[i * inner + k], B + k * cols + j0, width);
+            }
+          }
+        }
+      }
+    }
+  };
+
+  std::size_t nbands = (rows + MATMUL_TILE - 1) / MATMUL_TILE;
+  if((nbands > 1) && (rows * inner * cols >= PARALLEL_MATMUL)){
+    ThreadPool::instance().parallel_for(nbands, bands);
+  }
+  else{
+    bands(0, nbands);
+  }
+  CancellationToken::check();
+
+  out = std::move(result);
+  return true;
+}
+
+/***********************************************************************
+Element-wise Operations and Reductions
+**********************************************************************/
+
+bool matrixElementwise(Matrix & acc, const Matrix & x, MatrixOp op){
+
+  if((acc.rows() != x.rows()) || (acc.cols() != x.cols())){
+    return false;
+  }
+
+  apply_vv(acc.data(), x.data(), acc.rows() * acc.cols(), op);
+  return true;
+}
+
+void matrixElementwise(Matrix & acc, double x, MatrixOp op){
+  apply_vs(acc.data(), x, acc.rows() * acc.cols(), op);
+}
+
+std::vector<double> rowSums(const Matrix & m){
+
+  std::vector<double> sums(m.rows(), 0.0);
+
+  for(std::size_t i = 0; i < m.rows(); i++){
+    const double * row = m.data() + i * m.cols();
+    double sum = 0.0;
+    for(std::size_t j = 0; j < m.cols(); j++) sum += row[j];
+    sums[i] = sum;
+  }
+
+  return sums;
+}
+
+std::vector<double> columnSums(const Matrix & m){
+
+  // accumulate whole rows at a time rather than striding down each column
+  std::vector<double> sums(m.cols(), 0.0);
+
+  for(std::size_t i = 0; i < m.rows(); i++){
+    add_vv(sums.data(), m.data() + i * m.cols(), m.cols());
+  }
+
+  return sums;
+}
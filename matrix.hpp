@@ -0,0 +1,96 @@
+/*! \file matrix.hpp
+Defines the dense Matrix value type and its cache-blocked kernels.
+ */
+#ifndef MATRIX_HPP
+#define MATRIX_HPP
+
+#include "expression.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/*! \class Matrix
+\brief A dense two-dimensional array of Numbers in one row-major buffer.
+
+Entry (i, j) is stored at data()[i * cols() + j], so a row is contiguous and
+the kernels below walk the buffer in order wherever they can. An Expression
+holding a Matrix shares it, read-only, with its copies.
+ */
+class Matrix {
+public:
+
+  /// Construct an empty 0 x 0 Matrix
+  Matrix();
+
+  /// Construct a rows x cols Matrix with every entry set to fill
+  Matrix(std::size_t rows, std::size_t cols, double fill = 0.0);
+
+  /// number of rows
+  std::size_t rows() const noexcept;
+
+  /// number of columns
+  std::size_t cols() const noexcept;
+
+  /// entry (i, j), where i < rows() and j < cols()
+  double & operator()(std::size_t i, std::size_t j) noexcept;
+
+  /// entry (i, j), where i < rows() and j < cols()
+  double operator()(std::size_t i, std::size_t j) const noexcept;
+
+  /// the row-major entries
+  double * data() noexcept;
+
+  /// the row-major entries
+  const double * data() const noexcept;
+
+  /// equality comparison based on shape and entries
+  bool operator==(const Matrix & right) const noexcept;
+
+private:
+
+  std::size_t m_rows;
+  std::size_t m_cols;
+  std::vector<double> m_data;
+};
+
+/// the element-wise operations on Matrices
+enum class MatrixOp { Add, Sub, Mul, Div };
+
+/*! Read a non-empty List of equally long, non-empty Lists of Numbers, one
+  per row, into a Matrix.
+  \param exp the Expression to read
+  \param out the Matrix to fill
+  \return false if exp is not such a List
+ */
+bool toMatrix(const Expression & exp, Matrix & out);
+
+/*! Convert to a List of rows, each a List of Numbers.
+  \param m the Matrix to convert
+  \return the nested List toMatrix would read back into m
+ */
+Expression fromMatrix(const Matrix & m);
+
+/// the transpose of m, copied tile by tile
+Matrix transpose(const Matrix & m);
+
+/*! Matrix product out = a b, computed over tiles of a, b and out that fit
+  in cache, splitting the rows of out across the thread pool when large.
+  \return false, leaving out unchanged, if a.cols() != b.rows()
+ */
+bool matmul(const Matrix & a, const Matrix & b, Matrix & out);
+
+/*! acc(i, j) = acc(i, j) op x(i, j)
+  \return false, leaving acc unchanged, if the shapes differ
+ */
+bool matrixElementwise(Matrix & acc, const Matrix & x, MatrixOp op);
+
+/// acc(i, j) = acc(i, j) op x
+void matrixElementwise(Matrix & acc, double x, MatrixOp op);
+
+/// the sum of each row of m
+std::vector<double> rowSums(const Matrix & m);
+
+/// the sum of each column of m
+std::vector<double> columnSums(const Matrix & m);
+
+#endif
@@ -0,0 +1,104 @@
+#include "catch.hpp"
+
+#include "matrix.hpp"
+
+#include <sstream>
+
+// a rows x cols Matrix with distinct, non-trivial entries
+static Matrix sample(std::size_t rows, std::size_t cols, double seed)
+{
+  Matrix m(rows, cols);
+  for(std::size_t i = 0; i < rows; i++){
+    for(std::size_t j = 0; j < cols; j++){
+      m(i, j) = seed + 0.5 * i - 0.25 * j + ((i * 7 + j * 3) % 11);
+    }
+  }
+  return m;
+}
+
+TEST_CASE( "Test Matrix conversion", "[matrix]" )
+{
+  Expression list(Expression::List{ Expression(Expression::List{ Expression(1.0), Expression(2.0), Expression(3.0) }),
+                                    Expression(Expression::List{ Expression(4.0), Expression(5.0), Expression(6.0) }) });
+
+  Matrix m;
+  REQUIRE(toMatrix(list, m));
+  REQUIRE(m.rows() == 2);
+  REQUIRE(m.cols() == 3);
+  REQUIRE(m(1, 0) == 4.0);
+  REQUIRE(m.data()[5] == 6.0);
+  REQUIRE(fromMatrix(m) == list);
+
+  INFO("a Matrix prints as the List of rows it converts to");
+  std::ostringstream printed, expected;
+  printed << Expression::makeMatrix(m);
+  expected << list;
+  REQUIRE(printed.str() == expected.str());
+
+  INFO("only non-empty Lists of equal-length Lists of Numbers convert");
+  REQUIRE(!toMatrix(Expression(1.0), m));
+  REQUIRE(!toMatrix(Expression(Expression::List{}), m));
+  REQUIRE(!toMatrix(Expression(Expression::List{ Expression(1.0) }), m));
+  REQUIRE(!toMatrix(Expression(Expression::List{ Expression(Expression::List{}) }), m));
+  REQUIRE(!toMatrix(Expression(Expression::List{ Expression(Expression::List{ Expression(1.0) }),
+                                                  Expression(Expression::List{ Expression(1.0), Expression(2.0) }) }), m));
+  REQUIRE(!toMatrix(Expression(Expression::List{ Expression(Expression::List{ Expression(Atom("\"a\"")) }) }), m));
+
+  INFO("rows may be List views");
+  REQUIRE(toMatrix(Expression(Expression::List{ Expression::makeRange(1.0, 4.0, 1.0, 4) }), m));
+  REQUIRE(m.cols() == 4);
+  REQUIRE(m(0, 3) == 4.0);
+}
+
+TEST_CASE( "Test Matrix kernels", "[matrix]" )
+{
+  INFO("blocked products match the direct triple loop, across tile edges");
+  for(auto shape : std::vector<std::vector<std::size_t>>{ {1, 1, 1}, {2, 3, 4}, {65, 70, 63}, {130, 129, 140} }){
+    Matrix a = sample(shape[0], shape[1], 1.0);
+    Matrix b = sample(shape[1], shape[2], -2.0);
+    Matrix c;
+    REQUIRE(matmul(a, b, c));
+    REQUIRE(c.rows() == shape[0]);
+    REQUIRE(c.cols() == shape[2]);
+
+    for(std::size_t i = 0; i < c.rows(); i++){
+      for(std::size_t j = 0; j < c.cols(); j++){
+        double expected = 0.0;
+        for(std::size_t k = 0; k < a.cols(); k++) expected += a(i, k) * b(k, j);
+        REQUIRE(c(i, j) == Approx(expected));
+      }
+    }
+  }
+
+  Matrix c;
+  REQUIRE(!matmul(sample(2, 3, 0.0), sample(2, 3, 0.0), c));
+
+  Matrix m = sample(70, 33, 0.0);
+  Matrix t = transpose(m);
+  REQUIRE(t.rows() == 33);
+  REQUIRE(t.cols() == 70);
+  for(std::size_t i = 0; i < m.rows(); i++){
+    for(std::size_t j = 0; j < m.cols(); j++){
+      REQUIRE(t(j, i) == m(i, j));
+    }
+  }
+  REQUIRE(transpose(t) == m);
+
+  Matrix acc(2, 2, 6.0);
+  REQUIRE(matrixElementwise(acc, Matrix(2, 2, 2.0), MatrixOp::Sub));
+  REQUIRE(acc == Matrix(2, 2, 4.0));
+  REQUIRE(matrixElementwise(acc, Matrix(2, 2, 2.0), MatrixOp::Div));
+  REQUIRE(acc == Matrix(2, 2, 2.0));
+  matrixElementwise(acc, 3.0, MatrixOp::Mul);
+  REQUIRE(acc == Matrix(2, 2, 6.0));
+  matrixElementwise(acc, 1.0, MatrixOp::Add);
+  REQUIRE(acc == Matrix(2, 2, 7.0));
+  REQUIRE(!matrixElementwise(acc, Matrix(2, 3, 1.0), MatrixOp::Add));
+  REQUIRE(acc == Matrix(2, 2, 7.0));
+
+  Matrix r(2, 3);
+  double v = 1.0;
+  for(std::size_t i = 0; i < 2; i++) for(std::size_t j = 0; j < 3; j++) r(i, j) = v++;
+  REQUIRE(rowSums(r) == std::vector<double>({6.0, 15.0}));
+  REQUIRE(columnSums(r) == std::vector<double>({5.0, 7.0, 9.0}));
+}
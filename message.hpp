@@ -7,58 +7,79 @@
 #include <stdexcept>
 #include <exception>
 #include <iostream>
+#include <memory>
+#include <new>
 #include <string>
+#include <utility>
 
 /* This class is to be used by the Interpreter to encapsulate the
  * input Expression string sent through the input MessageQueue by the
  * main thread (TUI or GUI). It is also used to encapsulate the Expression
  * or Error result of evaluating each input Message, and pass it back
- * through the output MessageQueue to the main thread to display */
+ * through the output MessageQueue to the main thread to display.
+ *
+ * Only the active payload is stored. An Expression result is held by a
+ * shared pointer to an immutable Expression, so copying a Message, however
+ * large its result, copies a pointer. */
 class Message
 {
 	// Convenience typedef labels
 	//typedef std::exception_ptr Error;
 	typedef std::string String;
 	typedef std::string Error;
+	typedef std::shared_ptr<const Expression> SharedExp;
 
 public:
-	
+
 	// internal enum of known types
 	enum Type { NoneType, StringType, ExpressionType, ErrorType };
 
 	// constructors for use in container push, assignment, and output
 	Message() : type(NoneType){};
-	Message(Type t, const String & s){
+	Message(Type t, const String & s) : type(NoneType){
 		if(t == StringType) { setString(s); }
 		else if(t == ErrorType) { setError(s); }
-		else setNone();
 	}
-	Message(Type t, const Expression & e){
+	Message(Type t, const Expression & e) : type(NoneType){
 		if(t == ExpressionType) setExp(e);
-		else setNone();
+	}
+	Message(Type t, Expression && e) : type(NoneType){
+		if(t == ExpressionType) setExp(std::move(e));
 	}
 	//Message(InterpResultType t, const Error & e) : type(ErrorType), errValue(e){};
-	
+
+	// copy shares an Expression payload rather than copying it
+	Message(const Message & x) : type(NoneType), requestId(x.requestId){
+		assign(x);
+	}
+
+	// move takes over the payload, leaving x of NoneType
+	Message(Message && x) noexcept : type(NoneType), requestId(x.requestId){
+		take(x);
+	}
+
+	~Message(){
+		setNone();
+	}
+
 	// assignment needed for wait_and_pop
 	Message & operator=(const Message & x){
 		// prevent self-assignment
 		if(!(this == &x)){
-			if(x.type == NoneType){
-				type = NoneType;
-			}
-			else if(x.type == StringType){
-				setString(x.stringValue);
-			}
-			else if (x.type == ExpressionType){
-				setExp(x.expValue);
-			}
-			else if (x.type == ErrorType){
-				setError(x.errValue);
-			}
+			assign(x);
+			requestId = x.requestId;
 		}
 		return *this;
 	}
-	
+
+	Message & operator=(Message && x) noexcept{
+		if(!(this == &x)){
+			take(x);
+			requestId = x.requestId;
+		}
+		return *this;
+	}
+
 	bool isNone() const noexcept{
 		return type == NoneType;
 	}
@@ -66,45 +87,86 @@ public:
 	bool isString() const noexcept{
 		return type == StringType;
 	}
-	
+
 	bool isExpression() const noexcept{
 		return type == ExpressionType;
 	}
-	
+
 	bool isError() const noexcept{
 		return type == ErrorType;
 	}
 
-	void setNone(){
+	// destroy the active payload
+	void setNone() noexcept{
+		if((type == StringType) || (type == ErrorType)){
+			textValue.~String();
+		}
+		else if(type == ExpressionType){
+			expValue.~SharedExp();
+		}
 		type = NoneType;
 	}
 
 	void setString(const String & value){
-		type = StringType;
-		stringValue = value;
+		setText(StringType, value);
 	}
-	
+
 	void setExp(const Expression & value){
-		type = ExpressionType;
-		expValue = value;
+		setExp(std::make_shared<Expression>(value));
+	}
+
+	void setExp(Expression && value){
+		setExp(std::make_shared<Expression>(std::move(value)));
 	}
 
 	void setError(const Error & value){
-		type = ErrorType;
-		errValue = value;
+		setText(ErrorType, value);
+	}
+
+	// the id of the request this message carries, or answers; 0 if unset
+	unsigned long getRequestId() const noexcept{
+		return requestId;
+	}
+
+	void setRequestId(unsigned long id) noexcept{
+		requestId = id;
 	}
 
 	// opens the message and get value, similar to calling future.get()
 	Expression getExp(){
 		Expression result;
-		if(type == ExpressionType) { result = expValue; }
-		else if(type == ErrorType) { throw SemanticError(errValue); }
+		if(type == ExpressionType) { result = *expValue; }
+		else if(type == ErrorType) { throw SemanticError(textValue); }
+		return result;
+	}
+
+	// like getExp, but moves the Expression out, leaving this message's
+	// empty; copies it instead if another Message still shares it
+	Expression takeExp(){
+		if(type == ErrorType) { throw SemanticError(textValue); }
+		if(type != ExpressionType) { return Expression(); }
+
+		Expression result;
+		if(expValue.use_count() == 1){
+			// sole owner, and setExp made the Expression non-const, so it may be moved from
+			result = std::move(const_cast<Expression &>(*expValue));
+		}
+		else{
+			result = *expValue;
+		}
+		setNone();
 		return result;
 	}
 
+	// the shared Expression payload, nullptr if not an Expression; opens the
+	// message without copying the Expression
+	SharedExp getSharedExp() const noexcept{
+		return (type == ExpressionType) ? expValue : SharedExp();
+	}
+
 	String getString(){
 		String result;
-		if(type == StringType) { result = stringValue; }
+		if(type == StringType) { result = textValue; }
 		return result;
 	}
 
@@ -114,26 +176,12 @@ public:
 
 		switch(type){
 		case NoneType:
-			if (right.type != NoneType) return false;
 			break;
 		case StringType:
-			{
-				if (right.type != StringType) return false;
-				return stringValue == stringValue;
-			}
-			break;
-		case ExpressionType:
-			{
-				if (right.type != ExpressionType) return false;
-				return expValue == right.expValue;
-			}
-			break;
 		case ErrorType:
-			{
-				if (right.type != ErrorType) return false;
-				return errValue == right.errValue;
-			}
-			break;
+			return textValue == right.textValue;
+		case ExpressionType:
+			return (expValue == right.expValue) || (*expValue == *right.expValue);
 		default:
 			return false;
 		}
@@ -142,17 +190,65 @@ public:
 	}
 
 private:
-	
-	// internal enum of known types
-	//enum Type { NoneType, StringType, ExpressionType, ErrorType };
+
+	// share an Expression payload, always one made (non-const) by the public setExp
+	void setExp(SharedExp value){
+		setNone();
+		new (&expValue) SharedExp(std::move(value));
+		type = ExpressionType;
+	}
+
+	// set a String or Error payload
+	void setText(Type t, const String & value){
+		if((type == StringType) || (type == ErrorType)){
+			textValue = value;
+		}
+		else{
+			setNone();
+			new (&textValue) String(value);
+		}
+		type = t;
+	}
+
+	// copy the payload of x
+	void assign(const Message & x){
+		if(x.type == NoneType){
+			setNone();
+		}
+		else if(x.type == ExpressionType){
+			setExp(x.expValue);
+		}
+		else{
+			setText(x.type, x.textValue);
+		}
+	}
+
+	// move the payload of x, leaving x of NoneType
+	void take(Message & x) noexcept{
+		setNone();
+		if((x.type == StringType) || (x.type == ErrorType)){
+			new (&textValue) String(std::move(x.textValue));
+		}
+		else if(x.type == ExpressionType){
+			new (&expValue) SharedExp(std::move(x.expValue));
+		}
+		type = x.type;
+		x.setNone();
+	}
 
 	// track the type
 	Type type;
-	
-	// values for the known types
-	String stringValue;
-	Expression expValue;
-	Error errValue;
+
+	// the payload of the active type; a String or Error is the text, an
+	// Expression is shared read-only. Note the use of a union requires care
+	// when setting non POD values (see setText and setExp)
+	union {
+		String textValue;
+		SharedExp expValue;
+	};
+
+	// matches a result to its request when several kernels answer out of order
+	unsigned long requestId = 0;
 };
 
 //bool operator!=(const Message & left, const Message & right) noexcept{
@@ -9,6 +9,8 @@ www.justsoftwaresolutions.co.uk/threading/implementing-a-thread-safe-queue-using
 #include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <utility>
+#include <vector>
 
 template<typename MessageType>
 class MessageQueue
@@ -24,6 +26,39 @@ public:
     the_condition_variable.notify_one();
   }
 
+  // move message into queue, blocks until available
+  void push(MessageType&& message)
+  {
+    std::unique_lock<std::mutex> lock(the_mutex);
+    the_queue.push(std::move(message));
+    lock.unlock();
+    the_condition_variable.notify_one();
+  }
+
+  // construct message in place at the back of the queue
+  template<typename... Args>
+  void emplace(Args&&... args)
+  {
+    std::unique_lock<std::mutex> lock(the_mutex);
+    the_queue.emplace(std::forward<Args>(args)...);
+    lock.unlock();
+    the_condition_variable.notify_one();
+  }
+
+  // move every message into queue, in order, taking the lock once
+  void push_all(std::vector<MessageType>&& messages)
+  {
+    if(messages.empty()) return;
+
+    std::unique_lock<std::mutex> lock(the_mutex);
+    for(auto & message : messages){
+      the_queue.push(std::move(message));
+    }
+    lock.unlock();
+    messages.clear();
+    the_condition_variable.notify_all();
+  }
+
   // check if queue is empty, blocks until available
   bool empty() const
   {
@@ -31,20 +66,20 @@ public:
     return the_queue.empty();
   }
 
-  // pop message from queue, return false if queue is empty
+  // move message out of queue, return false if queue is empty
   bool try_pop(MessageType& popped_value)
   {
     std::lock_guard<std::mutex> lock(the_mutex);
     if(the_queue.empty()){
 			return false;
 		}
-        
-    popped_value=the_queue.front();
+
+    popped_value=std::move(the_queue.front());
     the_queue.pop();
     return true;
   }
 
-  // pop message from queue, blocks until the queue is nonempty
+  // move message out of queue, blocks until the queue is nonempty
   void wait_and_pop(MessageType& popped_value)
   {
     std::unique_lock<std::mutex> lock(the_mutex);
@@ -52,8 +87,36 @@ public:
 			the_condition_variable.wait(lock);
 		}
 
-    popped_value=the_queue.front();
+    popped_value=std::move(the_queue.front());
+    the_queue.pop();
+  }
+
+  // move message out of queue and return it, blocks until the queue is nonempty
+  MessageType wait_and_pop()
+  {
+    std::unique_lock<std::mutex> lock(the_mutex);
+    while(the_queue.empty()){
+			the_condition_variable.wait(lock);
+		}
+
+    MessageType popped_value(std::move(the_queue.front()));
     the_queue.pop();
+    return popped_value;
+  }
+
+  // move every queued message onto the end of drained, in order, taking the
+  // lock once; returns the number moved, 0 if queue is empty
+  std::size_t drain(std::vector<MessageType>& drained)
+  {
+    std::lock_guard<std::mutex> lock(the_mutex);
+    std::size_t n = the_queue.size();
+
+    drained.reserve(drained.size() + n);
+    while(!the_queue.empty()){
+      drained.push_back(std::move(the_queue.front()));
+      the_queue.pop();
+    }
+    return n;
   }
 
 private:
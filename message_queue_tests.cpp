@@ -0,0 +1,136 @@
+#include "catch.hpp"
+
+#include "message_queue.hpp"
+#include "message.hpp"
+
+#include <thread>
+#include <vector>
+
+// a List of n Numbers
+static Expression bigList(std::size_t n)
+{
+  Expression::List items;
+  for(std::size_t i = 0; i < n; i++){
+    items.emplace_back(Atom(double(i)));
+  }
+  return Expression(items);
+}
+
+TEST_CASE( "Test Message payloads", "[message_queue]" )
+{
+  Message message(Message::Type::StringType, "(+ 1 2)");
+  REQUIRE(message.isString());
+  REQUIRE(message.getString() == "(+ 1 2)");
+  REQUIRE(!message.getSharedExp());
+
+  message.setError("Error: oops");
+  REQUIRE(message.isError());
+  REQUIRE(message.getString() == "");
+  REQUIRE(message == Message(Message::Type::ErrorType, "Error: oops"));
+  REQUIRE(!(message == Message(Message::Type::StringType, "Error: oops")));
+  REQUIRE(!(message == Message(Message::Type::ErrorType, "Error: other")));
+
+  message.setExp(bigList(3));
+  REQUIRE(message.isExpression());
+  REQUIRE(message.getExp() == bigList(3));
+  REQUIRE(message == Message(Message::Type::ExpressionType, bigList(3)));
+
+  message.setNone();
+  REQUIRE(message.isNone());
+  REQUIRE(message == Message());
+
+  INFO("copies share one immutable Expression");
+  Message result(Message::Type::ExpressionType, bigList(100000));
+  result.setRequestId(9);
+  Message copy(result);
+  Message assigned;
+  assigned = copy;
+  REQUIRE(copy.getSharedExp() == result.getSharedExp());
+  REQUIRE(assigned.getSharedExp() == result.getSharedExp());
+  REQUIRE(assigned.getRequestId() == 9);
+  REQUIRE(assigned == result);
+
+  INFO("takeExp copies while the Expression is shared, and moves it once it is not");
+  Expression taken = copy.takeExp();
+  REQUIRE(copy.isNone());
+  REQUIRE(taken.listSize() == 100000);
+  REQUIRE(&*taken.tailConstBegin() != &*result.getSharedExp()->tailConstBegin());
+
+  assigned.setNone();
+  const Expression * entries = &*result.getSharedExp()->tailConstBegin();
+  taken = result.takeExp();
+  REQUIRE(&*taken.tailConstBegin() == entries);
+
+  INFO("a moved Message hands over its payload");
+  Message source(Message::Type::ExpressionType, bigList(2));
+  std::shared_ptr<const Expression> payload = source.getSharedExp();
+  Message moved(std::move(source));
+  REQUIRE(source.isNone());
+  REQUIRE(moved.getSharedExp() == payload);
+
+  Message text(Message::Type::StringType, "abc");
+  moved = std::move(text);
+  REQUIRE(moved.getString() == "abc");
+  REQUIRE(text.isNone());
+}
+
+TEST_CASE( "Test MessageQueue moves results through without copying", "[message_queue]" )
+{
+  MessageQueue<Message> queue;
+
+  Expression result = bigList(1000);
+  const Expression * entries = &*result.tailConstBegin();
+
+  Message message(Message::Type::ExpressionType, std::move(result));
+  message.setRequestId(3);
+  queue.push(std::move(message));
+
+  Message popped = queue.wait_and_pop();
+  REQUIRE(popped.getRequestId() == 3);
+
+  Expression exp = popped.takeExp();
+  REQUIRE(exp == bigList(1000));
+  REQUIRE(&*exp.tailConstBegin() == entries);
+
+  INFO("takeExp still reports errors");
+  queue.emplace(Message::Type::ErrorType, "Error: oops");
+  REQUIRE(queue.try_pop(popped));
+  REQUIRE_THROWS_AS(popped.takeExp(), SemanticError);
+  REQUIRE(!queue.try_pop(popped));
+}
+
+TEST_CASE( "Test MessageQueue batch operations", "[message_queue]" )
+{
+  MessageQueue<int> queue;
+  std::vector<int> drained;
+
+  REQUIRE(queue.drain(drained) == 0);
+  REQUIRE(drained.empty());
+
+  std::vector<int> batch = {1, 2, 3};
+  queue.push_all(std::move(batch));
+  REQUIRE(batch.empty());
+  queue.push(4);
+
+  drained.push_back(0);
+  REQUIRE(queue.drain(drained) == 4);
+  REQUIRE(drained == std::vector<int>({0, 1, 2, 3, 4}));
+  REQUIRE(queue.empty());
+
+  INFO("push_all wakes every waiting consumer");
+  std::vector<int> received(4, -1);
+  std::vector<std::thread> consumers;
+  for(int i = 0; i < 4; i++){
+    consumers.emplace_back([&queue, &received, i](){
+      received[i] = queue.wait_and_pop();
+    });
+  }
+  queue.push_all(std::vector<int>({10, 11, 12, 13}));
+  for(auto & consumer : consumers){
+    consumer.join();
+  }
+
+  int sum = 0;
+  for(int value : received) sum += value;
+  REQUIRE(sum == 46);
+}
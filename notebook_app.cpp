@@ -65,16 +65,10 @@ void NotebookApp::getUserText(QString inExp){
 
 int NotebookApp::startup(Interpreter & interp){
   
-  std::ifstream ifs(STARTUP_FILE);
+  std::istringstream ifs(STARTUP_PROGRAM);
   std::ostringstream err;
-
-  if(!ifs){
-    emit sendResult(errFormat("Error: Could not open startup file for reading."));
-    return EXIT_FAILURE;
-  }
   
   if(!interp.parseStream(ifs)){
-    ifs.close();
     emit sendResult(errFormat("Error: Invalid startup program. Could not parse."));
     return EXIT_FAILURE;
   }
@@ -83,14 +77,12 @@ int NotebookApp::startup(Interpreter & interp){
       Expression exp = interp.evaluate();
     }
     catch(const SemanticError & ex){
-      ifs.close();
       err << ex.what();
       emit sendResult(errFormat(err.str()));
       return EXIT_FAILURE;
     }	
   }
   
-  ifs.close();
   return EXIT_SUCCESS;
 }
 
@@ -139,20 +131,9 @@ Settings NotebookApp::setGraphicsType(Expression outExp){
   // The graphic object data to send to outputWidget
   Settings data;
   
-  // Pull out necessary parts of result Expression
-  Expression propExp = outExp.getProperty("\"object-name\"");
-  std::ostringstream nameStream;
-  nameStream << propExp;
-  std::string expName = nameStream.str();
-
-  // Convert Expression->string
-  std::ostringstream expStream;
-  expStream << outExp;
-  std::string expValue = expStream.str();
-  
-  qDebug() << "Data: " << QString::fromStdString(expName) << QString::fromStdString(expValue);
-  
-  // Assign graphic type and parameter data based on result
+  // Assign graphic type and parameter data based on result. The graphic kind
+  // is cached on the Expression and its fields are read as Numbers, so no
+  // strings are built or compared for graphic items
   if(outExp.isHeadLambda()){
     
     // Display nothing for procedures
@@ -160,115 +141,82 @@ Settings NotebookApp::setGraphicsType(Expression outExp){
   }
   else if(outExp.isTextG()){
     
-    QString text = QString::fromStdString(outExp.asString());
-    
-    // Default values
-    double x = 0;
-    double y = 0;
-    double scale = 1;
-    double rotate = 0;
+    // Default values are the origin, scale 1, and no rotation
+    Expression::TextG text;
 
     // If "position" is in prop list, must be type "point" or error
-    if(outExp.getProperty("\"position\"") != Expression()){
-
-      Expression expProp = outExp.getProperty("\"position\"");
-
-      if(expProp.isPointG()){
-        Expression::List points = expProp.asList();
-        x = points[0].head().asNumber();
-        y = points[1].head().asNumber();
-      }
-      else{
-        return errFormat("Error: Position not a point");
-      }
+    if(!outExp.asTextG(text)){
+      return errFormat("Error: Position not a point");
     }
-    
-    // If "text-scale" is in prop list, it should be a positive Number
-    if(outExp.getProperty("\"text-scale\"") != Expression()){
-
-      Expression expProp = outExp.getProperty("\"text-scale\"");
 
-      if( expProp.isHeadNumber() && (expProp.head().asNumber() > 0) ){
-        scale = expProp.head().asNumber();
-      }
-    }
-    
-    // If "text-rotation" is in prop list, it should be a Number in radians
-    if (outExp.getProperty("\"text-rotation\"") != Expression()) {
-
-      Expression expProp = outExp.getProperty("\"text-rotation\"");
-
-      if (expProp.isHeadNumber()) {
-        // Convert input to degrees for rotate function to work
-        double rad = expProp.head().asNumber();
-        double deg = rad * (180/std::atan2(0, -1));
-        rotate = deg;
-      }
-    }
+    // Convert rotation to degrees for rotate function to work
+    double rotate = text.rotation * (180/std::atan2(0, -1));
 
     // Package result values for output
-    data = Settings(Settings::Type::Text_Type, QPoint(x,y), text, scale, rotate);
+    data = Settings(Settings::Type::Text_Type, QPoint(text.x, text.y),
+                    QString::fromStdString(text.text), text.scale, rotate);
   }
   else if(outExp.isPointG()){
 
     // Center at the Point's coordinates with a diameter equal to the size property
-    Expression::List points = outExp.asList();
-    
-    double x = points[0].head().asNumber();
-    double y = points[1].head().asNumber();
-
-    double size = 0;
+    Expression::PointG point;
     
     // If "size" is present in the property list, it is an error if this property is not a positive Number.
-    if(outExp.getProperty("\"size\"") != Expression()){
-      
-      Expression expProp = outExp.getProperty("\"size\"");
-
-      if( expProp.head().isNumber() && (expProp.head().asNumber() > 0 ) ){
-        size = outExp.getProperty("\"size\"").head().asNumber();
-      }
-      else{
-        return errFormat("Error: Size is not a positive number");
-      }
+    if(!outExp.asPointG(point)){
+      return errFormat("Error: Size is not a positive number");
     }
     
     // Package result values for output
-    data = Settings(Settings::Type::Point_Type, QPoint(x, y), size);
+    data = Settings(Settings::Type::Point_Type, QPoint(point.x, point.y), point.size);
   }
   else if(outExp.isLineG()){
 
     // Use the Line's coordinates with a thickness equal to the thickness property.
-    Expression::List points = outExp.asList();
+    Expression::LineG line;
     
-    Expression::List point1 = points[0].asList();
-    Expression::List point2 = points[1].asList();
-
-    double x1 = point1[0].head().asNumber();
-    double y1 = point1[1].head().asNumber();
+    // If "thickness" is present in the property list, it is an error if this property is not a positive Number.
+    if(!outExp.asLineG(line)){
+      return errFormat("Error: Line ends are not points, or Thickness is not a positive number");
+    }
     
-    double x2 = point2[0].head().asNumber();
-    double y2 = point2[1].head().asNumber();
+    // Package result values for output
+    data = Settings(Settings::Type::Line_Type, QPoint(line.x1, line.y1), QPoint(line.x2, line.y2), line.thickness);
+  }
+  else if(outExp.isPointCloudG()){
+
+    // Every point shares the diameter given by the size property
+    Expression::PointCloudG cloud;
+
+    // If "size" is present in the property list, it is an error if this property is not a positive Number.
+    if(!outExp.asPointCloudG(cloud)){
+      return errFormat("Error: Size is not a positive number");
+    }
+
+    QVector<QPointF> points(cloud.xs.size());
+    for(std::size_t i = 0; i < cloud.xs.size(); i++){
+      points[i] = QPointF(cloud.xs[i], cloud.ys[i]);
+    }
+
+    // Package result values for output
+    data = Settings(Settings::Type::PointCloud_Type, points, cloud.size);
+  }
+  else if(outExp.isPolylineG()){
+
+    // Join the points in order with a thickness equal to the thickness property.
+    Expression::PolylineG line;
 
-    QPoint p1(x1, y1);
-    QPoint p2(x2, y2);
-    
-    double thicc = 1;
-    
     // If "thickness" is present in the property list, it is an error if this property is not a positive Number.
-    if(outExp.getProperty("\"thickness\"") != Expression()){
-      
-      Expression expProp = outExp.getProperty("\"thickness\"");
-
-      if( expProp.head().isNumber() && (expProp.head().asNumber() >= 0 ) ){
-        thicc = outExp.getProperty("\"thickness\"").head().asNumber();
-      }
-      else{
-        return errFormat("Error: Thickness is not a positive number");
-      }
+    if(!outExp.asPolylineG(line)){
+      return errFormat("Error: Thickness is not a positive number");
     }
-    
+
+    QVector<QPointF> points(line.xs.size());
+    for(std::size_t i = 0; i < line.xs.size(); i++){
+      points[i] = QPointF(line.xs[i], line.ys[i]);
+    }
+
     // Package result values for output
-    data = Settings(Settings::Type::Line_Type, p1, p2, thicc);
+    data = Settings(Settings::Type::Polyline_Type, points, line.thickness);
   }
   else if(outExp.isHeadList() && (!outExp.isTailEmpty())){
 
@@ -283,12 +231,15 @@ Settings NotebookApp::setGraphicsType(Expression outExp){
   }
   else{ // None, Number, Complex, Symbol, String
     
+    // Convert Expression->string
+    std::ostringstream expStream;
+    expStream << outExp;
+    std::string expValue = expStream.str();
+
     // Package result values for output
     data = Settings(Settings::Type::TUI_Type, QString::fromStdString(expValue));
   }
   
-  qDebug() << "Result: " << data.itemType;
-  
   // Send graphic item parameters to output widget to display
   return data;
 }
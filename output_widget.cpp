@@ -16,6 +16,7 @@
 #include <QPointF>
 #include <QRectF>
 #include <QLineF>
+#include <QPainterPath>
 
 #include <QGraphicsItem>
 #include <QGraphicsTextItem>
@@ -169,6 +170,35 @@ void OutputWidget::drawItem(Settings data){
 			qDebug() << "View Pos: " << m_view->itemAt(0, 0) << m_view->itemAt(data.pos);
 		}
 		break;
+  case Settings::Type::PointCloud_Type:
+		{
+			// All the points are circles of one path, drawn as a single item
+			QPainterPath path;
+			for(auto & point : data.points){
+				path.addEllipse(point, data.size / 2, data.size / 2);
+			}
+			m_item = m_scene->addPath(path, pen, pen.brush());
+
+			qDebug() << "Point Cloud Data: " << data.points.size() << "points";
+		}
+		break;
+  case Settings::Type::Polyline_Type:
+		{
+			// All the segments are one open path, drawn as a single item
+			QPainterPath path;
+			if(!data.points.isEmpty()){
+				path.moveTo(data.points.front());
+				for(int i = 1; i < data.points.size(); i++){
+					path.lineTo(data.points[i]);
+				}
+			}
+
+			pen.setWidth(data.thicc);
+			m_item = m_scene->addPath(path, pen);
+
+			qDebug() << "Polyline Data: " << data.points.size() << "points";
+		}
+		break;
   case Settings::Type::List_Type:
 		{
 			qDebug() << "List Data: ";
@@ -1,13 +1,18 @@
+#include <csignal>
+#include <deque>
+#include <map>
 #include <string>
 #include <sstream>
 #include <iostream>
 #include <fstream>
 #include <thread>
+#include <vector>
 
 #include "interpreter.hpp"
+#include "interpreter_pool.hpp"
 #include "semantic_error.hpp"
-#include "startup_config.hpp"
 #include "message_queue.hpp"
+#include "spsc_queue.hpp"
 #include "message.hpp"
 
 //typedef std::string InputMessage;
@@ -32,44 +37,12 @@ void info(const std::string & err_str){
   std::cout << "Info: " << err_str << std::endl;
 }
 
-int startup(Interpreter & interp){
-  
-  std::ifstream ifs(STARTUP_FILE);
-  
-  if(!ifs){
-    error("Could not open file for reading.");
-    return EXIT_FAILURE;
-  }
-  
-  if(!interp.parseStream(ifs)){
-    ifs.close();
-    error("Invalid Program. Could not parse.");
-    return EXIT_FAILURE;
-  }
-  else{
-    try{
-      Expression exp = interp.evaluate();
-    }
-    catch(const SemanticError & ex){
-      ifs.close();
-      std::cerr << ex.what() << std::endl;
-      return EXIT_FAILURE;
-    }	
-  }
-  
-  ifs.close();
-  return EXIT_SUCCESS;
-}
-
 int eval_from_stream(std::istream & stream){
 
   Interpreter interp;
   
-  /*** Evaluate startup.pls ***/
-  if(startup(interp) != 0){
-    error("Invalid Startup Program.");
-    return EXIT_FAILURE;
-  }
+  /*** Fork the environment left by startup.pls ***/
+  interp.reset();
 
   if(!interp.parseStream(stream)){
     error("Invalid Program. Could not parse.");
@@ -110,6 +83,58 @@ int eval_from_command(std::string argexp){
 
 
 
+// Evaluate each non-empty line of a file as an independent program, on one
+// kernel per hardware thread, printing the results in input order
+int eval_batch(std::string filename){
+
+  std::ifstream ifs(filename);
+
+  if(!ifs){
+    error("Could not open file for reading.");
+    return EXIT_FAILURE;
+  }
+
+  MessageQueue<Message> inputQueue;
+  MessageQueue<Message> outputQueue;
+  InterpreterPool pool(std::thread::hardware_concurrency(), &inputQueue, &outputQueue);
+
+  // request ids are line numbers among the non-empty lines, from 1
+  std::vector<Message> batch;
+  std::string line;
+  while(std::getline(ifs, line)){
+    if(line.empty()) continue;
+
+    batch.emplace_back(Message::Type::StringType, line);
+    batch.back().setRequestId(batch.size());
+  }
+  unsigned long requests = batch.size();
+  inputQueue.push_all(std::move(batch));
+
+  pool.start();
+
+  std::vector<Message> results(requests);
+  for(unsigned long i = 0; i < requests; i++){
+    Message result = outputQueue.wait_and_pop();
+    results[result.getRequestId() - 1] = std::move(result);
+  }
+
+  pool.stop();
+
+  int status = EXIT_SUCCESS;
+  for(auto & result : results){
+    try{
+      Expression exp = result.takeExp();
+      std::cout << exp << std::endl;
+    }
+    catch(const SemanticError & ex){
+      std::cerr << ex.what() << std::endl;
+      status = EXIT_FAILURE;
+    }
+  }
+
+  return status;
+}
+
 bool isRunning(std::thread * kernel) noexcept{
 	
 	//return kernel.joinable();
@@ -159,17 +184,99 @@ void reset(std::thread * kernel, Interpreter * interp, MessageQueue<Message> * i
 	}
 }
 
+// The kernel the REPL is waiting on, interrupted by Ctrl-C
+static Interpreter * interruptTarget = nullptr;
+
+// Ctrl-C stops the evaluation in progress rather than the program; at the
+// prompt it has no effect. Interrupting only stores to a lock-free atomic,
+// so it is safe to do here.
+extern "C" void interrupt_handler(int signal){
+	if(interruptTarget != nullptr){
+		interruptTarget->interrupt();
+	}
+	std::signal(signal, interrupt_handler);
+}
+
+// A line read by the REPL whose output has not been printed yet
+struct PendingLine{
+	bool prompted;				// its prompt was printed when it was read
+	unsigned long requestId;	// the program submitted, 0 for a blank line
+};
+
+// True if more input has already arrived, such as the rest of a paste or
+// of piped input, so reading it now will not block
+bool inputReady(){
+	return std::cin.rdbuf()->in_avail() > 0;
+}
+
+// Results taken from the kernel ahead of the line they answer, by request id
+typedef std::map<unsigned long, Message> ArrivedResults;
+
+// Take the result of request id, keeping any result for a later request
+// that arrives first; a result for an earlier one has no line left to print
+Message resultFor(unsigned long id, SpscQueue<Message> & outputQ, ArrivedResults & arrived){
+
+	Message result;
+
+	auto early = arrived.find(id);
+	if(early != arrived.end()){
+		result = std::move(early->second);
+		arrived.erase(early);
+		return result;
+	}
+
+	while(true){
+		outputQ.wait_and_pop(result);
+		if(result.getRequestId() == id) break;
+		if(result.getRequestId() > id){
+			arrived.emplace(result.getRequestId(), std::move(result));
+		}
+	}
+	return result;
+}
+
+// Print the prompt and result of every pending line, in order, waiting for
+// results still being evaluated. Each result is matched to its line by
+// request id rather than by the order it arrives in.
+void printPending(std::deque<PendingLine> & pending, SpscQueue<Message> & outputQ, ArrivedResults & arrived){
+
+	while(!pending.empty()){
+		PendingLine next = pending.front();
+		pending.pop_front();
+
+		if(!next.prompted) prompt();
+		if(next.requestId == 0) continue;
+
+		Message result = resultFor(next.requestId, outputQ, arrived);
+		try{
+			Expression exp = result.takeExp();
+			std::cout << exp << std::endl;
+		}
+		catch(const SemanticError & ex){
+			std::cerr << ex.what() << std::endl;
+		}
+	}
+}
+
 // If a user enters a plotscript expression when the interpreter is not
 // running, display the error message: "Error: interpreter kernel not running".
 
 // A REPL is a repeated read-eval-print loop
 void repl(){
   
-	MessageQueue<Message> inputQueue;
-	MessageQueue<Message> outputQueue;
+	// Untie the standard streams from C stdio so cin buffers its input and
+	// can report when more is waiting
+	std::ios_base::sync_with_stdio(false);
+
+	// The REPL is the only thread feeding the kernel and reading its results
+	SpscQueue<Message> inputQueue;
+	SpscQueue<Message> outputQueue;
 
 	// Initialize Interpreter object and check results of startup
 	Interpreter interp(&inputQueue, &outputQueue);
+
+	interruptTarget = &interp;
+	std::signal(SIGINT, interrupt_handler);
 	
 	//if(!outputQueue.empty()){
 	//	Message result;
@@ -189,13 +296,41 @@ void repl(){
 	kernelThread = new std::thread(&Interpreter::threadEvalLoop, std::ref(interp));
 	//std::thread interpKernel(interp);
 
+	// Lines are submitted as soon as they are read. While more input is
+	// waiting the REPL keeps reading, so the kernel never idles between
+	// lines, and only prints the output of the lines read so far before
+	// it next prompts for input.
+	std::deque<PendingLine> pending;
+	ArrivedResults arrived;
+
   while(!std::cin.eof()){
-    
-    prompt();
+
+		// Reading ahead stops well short of the queue capacity, so the kernel
+		// is never blocked on a full output queue while the REPL is blocked
+		// on a full input queue
+		bool prompted = false;
+		if(pending.empty() || !inputReady() || (pending.size() >= outputQueue.capacity() / 2)){
+			printPending(pending, outputQueue, arrived);
+			prompt();
+			prompted = true;
+		}
 		std::string line = readline();
-    
-    if(line.empty()) continue;
-		
+
+		if(line.empty()){
+			if(!prompted) pending.push_back(PendingLine{false, 0});
+			continue;
+		}
+
+		bool command = (line == "%exit") || (line == "%start") || (line == "%stop") || (line == "%reset");
+		if(!command && isRunning(kernelThread)){
+			pending.push_back(PendingLine{prompted, interp.submit(line)});
+			continue;
+		}
+
+		// Commands, and errors, follow the output of every line before them
+		printPending(pending, outputQueue, arrived);
+		if(!prompted) prompt();
+
 		// Check for special kernel control commands?
 		if(line == "%exit"){
 			if(isRunning(kernelThread)){
@@ -239,22 +374,8 @@ void repl(){
 			error("interpreter kernel not running");
 			continue;
 		}
-
-		// Push message to input queue
-		inputQueue.push(Message(Message::Type::StringType, line));
-
-		// Asynchronously receive output results to display
-		Message result;
-		outputQueue.wait_and_pop(result);
-		
-		try{
-      Expression exp = result.getExp();
-			std::cout << exp << std::endl;
-    }
-    catch(const SemanticError & ex){
-      std::cerr << ex.what() << std::endl;
-    }
 	}
+	printPending(pending, outputQueue, arrived);
 	
 	// Double-check the Interpreter kernel was told to stop
 	if(isRunning(kernelThread)){
@@ -265,6 +386,9 @@ void repl(){
 	}
 	// Double-check current # of threads is 1 (how can I do this?)
 
+	std::signal(SIGINT, SIG_DFL);
+	interruptTarget = nullptr;
+
 	// End of program
 }
 
@@ -277,6 +401,9 @@ int main(int argc, char *argv[])
     if(std::string(argv[1]) == "-e"){
       return eval_from_command(argv[2]);
     }
+    else if(std::string(argv[1]) == "-b"){
+      return eval_batch(argv[2]);
+    }
     else{
       error("Incorrect number of command line arguments.");
     }
@@ -2,6 +2,7 @@ import pexpect
 import pexpect.replwrap as replwrap
 import unittest
 import os
+import subprocess
         
 # the plotscript executable
 cmd = './plotscript'
@@ -39,7 +40,20 @@ class TestREPL(unittest.TestCase):
         def test_error(self):
                 output = self.wrapper.run_command(u'(define begin True)')
                 self.assertTrue(output.strip().startswith('Error'))
-                                
+
+class TestPipelinedREPL(unittest.TestCase):
+
+        def test_failing_line(self):
+                # piped input is read ahead, so every line is submitted before
+                # the first result is printed
+                lines = [u'(define a 1)', u'(+ a 1)', u'(a b)', u'(define b 5)', u'', u'(+ a b)']
+                run = subprocess.run([cmd], input=u'\n'.join(lines).encode(),
+                                     stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+                self.assertEqual(run.returncode, 0)
+                results = [r.strip() for r in run.stdout.decode().split(prompt)]
+                self.assertEqual(results[1:], [u'(1)', u'(2)', u'Error during evaluation: unknown symbol',
+                                               u'(5)', u'', u'(6)'])
+
 class TestExecuteCommandline(unittest.TestCase):
                 
         def test_sub(self):
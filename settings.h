@@ -5,6 +5,7 @@
 #include <QVector>
 #include <QString>
 #include <QPoint>
+#include <QPointF>
 
 /* This structure is to be used by NotebookApp::setGraphicsType(Expression exp)
  * to encapsulate the type and data parameters of each evaluated expression, and
@@ -12,7 +13,7 @@
 struct Settings {
   
   // internal enum of known types
-  enum Type { None_Type, TUI_Type, Text_Type, Point_Type, Line_Type, List_Type };
+  enum Type { None_Type, TUI_Type, Text_Type, Point_Type, Line_Type, List_Type, PointCloud_Type, Polyline_Type };
   
   // track the type, default none
   Type itemType = None_Type;
@@ -22,10 +23,11 @@ struct Settings {
   QString text; // used when type is Text_Type or TUI_Type
   double scale; // used when type is Text_Type
   double rotate;// used when type is Text_Type
-  double size;  // used when type is Point_Type
+  double size;  // used when type is Point_Type or PointCloud_Type
   QPoint p1;		// used when type is Line_Type
   QPoint p2;		// used when type is Line_Type
-	double thicc; // used when type is Line_Type
+	double thicc; // used when type is Line_Type or Polyline_Type
+  QVector<QPointF> points; // used when type is PointCloud_Type or Polyline_Type
 
   // constructors for use in assignment, signal, and output
   Settings() {};
@@ -34,6 +36,7 @@ struct Settings {
   Settings(Type p, QPoint c, double s) : itemType(p), pos(c), size(s) {};
   Settings(Type l, QPoint p1, QPoint p2, double t) : itemType(l), p1(p1), p2(p2), thicc(t) {};
   Settings(Type v, QVector<Settings> l) : itemType(v), list(l) {};
+  Settings(Type b, QVector<QPointF> pts, double w) : itemType(b), size(w), thicc(w), points(pts) {};
 };
 
 #endif
@@ -0,0 +1,164 @@
+/*! \file spsc_queue.hpp
+Defines a bounded, lock-free queue for a channel with exactly one producer
+thread and one consumer thread.
+ */
+
+#ifndef _SPSC_QUEUE_HPP_
+#define _SPSC_QUEUE_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*! \class SpscQueue
+\brief A ring buffer with the push/try_pop/wait_and_pop interface of
+MessageQueue, for one producer and one consumer.
+
+The producer only writes the tail index and the consumer only writes the
+head index, so neither side takes a lock to move a message. A side that
+finds the buffer full (producer) or empty (consumer) spins briefly, then
+parks on a condition variable. The other side only locks to wake it up, and
+only when the parked flag is set.
+ */
+template<typename MessageType>
+class SpscQueue
+{
+public:
+
+  /// Create a queue holding up to capacity messages, rounded up to a power of two
+  explicit SpscQueue(std::size_t capacity = 1024)
+    : m_head(0), m_tail(0), m_consumerParked(false), m_producerParked(false)
+  {
+    std::size_t size = 2;
+    while(size < capacity) size <<= 1;
+    m_slots.resize(size);
+    m_mask = size - 1;
+  }
+
+  SpscQueue(const SpscQueue &) = delete;
+  SpscQueue & operator=(const SpscQueue &) = delete;
+
+  /// number of messages the queue can hold
+  std::size_t capacity() const noexcept
+  {
+    return m_slots.size();
+  }
+
+  // push message into queue, blocks while the queue is full
+  void push(MessageType const& message)
+  {
+    MessageType copy(message);
+    push(std::move(copy));
+  }
+
+  // move message into queue, blocks while the queue is full
+  void push(MessageType&& message)
+  {
+    std::size_t tail = m_tail.load(std::memory_order_relaxed);
+
+    wait_for(m_producerParked, [this, tail](){
+      return tail - m_head.load(std::memory_order_seq_cst) < m_slots.size();
+    });
+
+    m_slots[tail & m_mask] = std::move(message);
+    m_tail.store(tail + 1, std::memory_order_seq_cst);
+
+    wake(m_consumerParked);
+  }
+
+  // check if queue is empty
+  bool empty() const
+  {
+    return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+  }
+
+  // pop message from queue, return false if queue is empty
+  bool try_pop(MessageType& popped_value)
+  {
+    std::size_t head = m_head.load(std::memory_order_relaxed);
+    if(head == m_tail.load(std::memory_order_acquire)){
+      return false;
+    }
+
+    pop_at(head, popped_value);
+    return true;
+  }
+
+  // pop message from queue, blocks until the queue is nonempty
+  void wait_and_pop(MessageType& popped_value)
+  {
+    std::size_t head = m_head.load(std::memory_order_relaxed);
+
+    wait_for(m_consumerParked, [this, head](){
+      return head != m_tail.load(std::memory_order_seq_cst);
+    });
+
+    pop_at(head, popped_value);
+  }
+
+private:
+
+  // checks of the other side's index before parking; the first half are
+  // plain re-reads, the rest yield the processor between reads
+  static const int SPIN_LIMIT = 256;
+
+  void pop_at(std::size_t head, MessageType& popped_value)
+  {
+    popped_value = std::move(m_slots[head & m_mask]);
+    m_head.store(head + 1, std::memory_order_seq_cst);
+
+    wake(m_producerParked);
+  }
+
+  // Wait until ready() holds, spinning first. The parked flag is set before
+  // ready() is checked for the last time, and the other side publishes its
+  // index before reading the flag (both sequentially consistent), so one of
+  // the two always sees the other and a wake-up cannot be lost.
+  template<typename Ready>
+  void wait_for(std::atomic<bool> & parked, Ready ready)
+  {
+    for(int i = 0; i < SPIN_LIMIT; i++){
+      if(ready()) return;
+      if(i >= SPIN_LIMIT / 2) std::this_thread::yield();
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    parked.store(true, std::memory_order_seq_cst);
+    m_condition.wait(lock, ready);
+    parked.store(false, std::memory_order_relaxed);
+  }
+
+  void wake(std::atomic<bool> & parked)
+  {
+    if(parked.load(std::memory_order_seq_cst)){
+      // notify under the lock so the waiter is either before its last check
+      // of ready() or already waiting, never in between. Both sides share
+      // the condition variable, so wake both
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_condition.notify_all();
+    }
+  }
+
+  std::vector<MessageType> m_slots;
+  std::size_t m_mask;
+
+  // the indices only grow; slot i is m_slots[i & m_mask]. Each is written by
+  // one side, and is padded onto its own cache line so the two sides do not
+  // invalidate each other's line on every message
+  std::atomic<std::size_t> m_head; // next to pop, written by the consumer
+  char m_pad1[64];
+  std::atomic<std::size_t> m_tail; // next to push, written by the producer
+  char m_pad2[64];
+
+  // a side blocked on a full or empty queue
+  std::atomic<bool> m_consumerParked;
+  std::atomic<bool> m_producerParked;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+};
+
+#endif // _SPSC_QUEUE_HPP_
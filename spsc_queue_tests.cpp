@@ -0,0 +1,90 @@
+#include "catch.hpp"
+
+#include "spsc_queue.hpp"
+#include "message.hpp"
+
+#include <thread>
+
+TEST_CASE( "Test SpscQueue in one thread", "[spsc_queue]" )
+{
+  SpscQueue<int> queue(5);
+  REQUIRE(queue.capacity() == 8);
+  REQUIRE(queue.empty());
+
+  int value = -1;
+  REQUIRE(!queue.try_pop(value));
+  REQUIRE(value == -1);
+
+  INFO("messages come out in order as the indices wrap around the buffer");
+  for(int round = 0; round < 5; round++){
+    for(int i = 0; i < 8; i++){
+      queue.push(round * 8 + i);
+    }
+    REQUIRE(!queue.empty());
+    for(int i = 0; i < 8; i++){
+      if(i % 2){
+        REQUIRE(queue.try_pop(value));
+      }
+      else{
+        queue.wait_and_pop(value);
+      }
+      REQUIRE(value == round * 8 + i);
+    }
+    REQUIRE(queue.empty());
+  }
+
+  SpscQueue<Message> messages;
+  Message request(Message::Type::StringType, "(+ 1 2)");
+  request.setRequestId(7);
+  messages.push(request);
+
+  Message popped;
+  messages.wait_and_pop(popped);
+  REQUIRE(popped.getString() == "(+ 1 2)");
+  REQUIRE(popped.getRequestId() == 7);
+}
+
+TEST_CASE( "Test SpscQueue between two threads", "[spsc_queue]" )
+{
+  INFO("a small buffer makes both sides wait: the producer when full, the consumer when empty");
+  SpscQueue<int> queue(4);
+  const int n = 100000;
+
+  std::thread producer([&queue, n](){
+    for(int i = 0; i < n; i++){
+      queue.push(i);
+    }
+  });
+
+  bool ordered = true;
+  for(int i = 0; i < n; i++){
+    int value;
+    queue.wait_and_pop(value);
+    ordered = ordered && (value == i);
+  }
+  producer.join();
+
+  REQUIRE(ordered);
+  REQUIRE(queue.empty());
+
+  INFO("a round trip over a pair of queues, as between the REPL and a kernel");
+  SpscQueue<int> requests(2), results(2);
+  std::thread kernel([&requests, &results, n](){
+    for(int i = 0; i < n / 10; i++){
+      int value;
+      requests.wait_and_pop(value);
+      results.push(value + 1);
+    }
+  });
+
+  int sum = 0;
+  for(int i = 0; i < n / 10; i++){
+    int value;
+    requests.push(i);
+    results.wait_and_pop(value);
+    sum += value - i;
+  }
+  kernel.join();
+
+  REQUIRE(sum == n / 10);
+}
@@ -0,0 +1,140 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+// the pool whose worker is running on this thread, if any
+static thread_local const ThreadPool * workerOf = nullptr;
+
+ThreadPool::ThreadPool(std::size_t workers): m_queued(0), m_stop(false){
+
+  workers = std::max<std::size_t>(workers, 1);
+
+  for(std::size_t i = 0; i < workers; i++){
+    m_deques.emplace_back(new TaskDeque);
+  }
+  for(std::size_t i = 0; i < workers; i++){
+    m_workers.emplace_back(&ThreadPool::run, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool(){
+
+  {
+    std::lock_guard<std::mutex> lock(m_wakeMutex);
+    m_stop = true;
+  }
+  m_wake.notify_all();
+
+  for(auto & worker : m_workers){
+    worker.join();
+  }
+}
+
+ThreadPool & ThreadPool::instance(){
+
+  static ThreadPool pool(std::thread::hardware_concurrency());
+  return pool;
+}
+
+std::size_t ThreadPool::size() const noexcept{
+  // the deques are all created before any worker starts, unlike m_workers
+  return m_deques.size();
+}
+
+void ThreadPool::parallel_for(std::size_t n, const std::function<void(std::size_t, std::size_t)> & body){
+
+  if(n == 0) return;
+
+  // a worker waiting on its own pool could leave no one to run the chunks,
+  // so nested calls run inline on the worker that makes them
+  if(workerOf == this){
+    body(0, n);
+    return;
+  }
+
+  // a few chunks per worker leaves something to steal when work is uneven
+  std::size_t chunks = std::min(n, 4 * size());
+
+  std::size_t remaining = chunks;
+  std::mutex doneMutex;
+  std::condition_variable done;
+
+  for(std::size_t c = 0; c < chunks; c++){
+    std::size_t begin = (n * c) / chunks;
+    std::size_t end = (n * (c + 1)) / chunks;
+
+    Task task = [&body, &remaining, &doneMutex, &done, begin, end](){
+      body(begin, end);
+
+      // count under the lock so the waiter cannot return, destroying the
+      // mutex and condition variable, before this notify has finished
+      std::lock_guard<std::mutex> lock(doneMutex);
+      if(--remaining == 0){
+        done.notify_one();
+      }
+    };
+
+    TaskDeque & deque = *m_deques[c % size()];
+    std::lock_guard<std::mutex> lock(deque.mutex);
+    deque.tasks.push_back(task);
+    m_queued++;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_wakeMutex);
+  }
+  m_wake.notify_all();
+
+  std::unique_lock<std::mutex> lock(doneMutex);
+  done.wait(lock, [&remaining](){ return remaining == 0; });
+}
+
+void ThreadPool::run(std::size_t index){
+
+  workerOf = this;
+
+  while(true){
+    Task task;
+    if(pop(index, task) || steal(index, task)){
+      task();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    m_wake.wait(lock, [this](){ return m_stop || (m_queued > 0); });
+    if(m_stop && (m_queued == 0)){
+      return;
+    }
+  }
+}
+
+bool ThreadPool::pop(std::size_t index, Task & task){
+
+  TaskDeque & deque = *m_deques[index];
+  std::lock_guard<std::mutex> lock(deque.mutex);
+
+  if(deque.tasks.empty()){
+    return false;
+  }
+
+  task = std::move(deque.tasks.back());
+  deque.tasks.pop_back();
+  m_queued--;
+  return true;
+}
+
+bool ThreadPool::steal(std::size_t index, Task & task){
+
+  for(std::size_t i = 1; i < size(); i++){
+    TaskDeque & deque = *m_deques[(index + i) % size()];
+    std::lock_guard<std::mutex> lock(deque.mutex);
+
+    if(!deque.tasks.empty()){
+      task = std::move(deque.tasks.front());
+      deque.tasks.pop_front();
+      m_queued--;
+      return true;
+    }
+  }
+  return false;
+}
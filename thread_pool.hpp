@@ -0,0 +1,81 @@
+/*! \file thread_pool.hpp
+Defines a work-stealing thread pool used to evaluate independent pieces of
+work, such as the entries of a pmap, in parallel.
+ */
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+// system includes
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*! \class ThreadPool
+\brief A fixed set of worker threads, each with its own task deque.
+
+A worker pops tasks from the back of its own deque and, once that is empty,
+steals from the front of the other workers' deques, so a worker that
+finishes its share early keeps busy until all the work is done.
+ */
+class ThreadPool {
+public:
+
+  /// Start a pool of the given number of workers (at least one)
+  explicit ThreadPool(std::size_t workers);
+
+  /// Finish any queued tasks and join the workers
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool & operator=(const ThreadPool &) = delete;
+
+  /// The process-wide pool, with one worker per hardware thread
+  static ThreadPool & instance();
+
+  /// number of worker threads
+  std::size_t size() const noexcept;
+
+  /*! Split [0, n) into chunks and run body(begin, end) on each chunk in the
+    pool, blocking until every chunk has finished. body must not throw.
+    Called from one of this pool's own workers, body(0, n) simply runs inline.
+    \param n the number of indices to cover
+    \param body the function to run on each half-open chunk of indices
+   */
+  void parallel_for(std::size_t n, const std::function<void(std::size_t, std::size_t)> & body);
+
+private:
+
+  typedef std::function<void()> Task;
+
+  // a worker's deque, locked independently so stealing rarely contends
+  struct TaskDeque {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  // main loop of the worker with the given index
+  void run(std::size_t index);
+
+  // take a task from the back of this worker's own deque
+  bool pop(std::size_t index, Task & task);
+
+  // take a task from the front of another worker's deque
+  bool steal(std::size_t index, Task & task);
+
+  std::vector<std::unique_ptr<TaskDeque>> m_deques;
+  std::vector<std::thread> m_workers;
+
+  // tasks queued but not yet taken, and the idle workers' wake-up signal
+  std::atomic<std::size_t> m_queued;
+  std::mutex m_wakeMutex;
+  std::condition_variable m_wake;
+  bool m_stop;
+};
+
+#endif
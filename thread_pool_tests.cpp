@@ -0,0 +1,52 @@
+#include "catch.hpp"
+
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_CASE( "Test parallel_for covers every index once", "[thread_pool]" )
+{
+  ThreadPool pool(4);
+  REQUIRE(pool.size() == 4);
+
+  for(std::size_t n : {0, 1, 3, 16, 1001}){
+    INFO(n);
+    std::vector<int> hits(n, 0);
+
+    pool.parallel_for(n, [&hits](std::size_t begin, std::size_t end){
+      for(std::size_t i = begin; i < end; i++) hits[i]++;
+    });
+
+    REQUIRE(hits == std::vector<int>(n, 1));
+  }
+}
+
+TEST_CASE( "Test idle workers steal uneven work", "[thread_pool]" )
+{
+  ThreadPool pool(4);
+  std::atomic<int> total(0);
+
+  // the first chunk is far slower than the rest, the others still finish
+  pool.parallel_for(64, [&total](std::size_t begin, std::size_t end){
+    if(begin == 0){
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    total += static_cast<int>(end - begin);
+  });
+
+  REQUIRE(total == 64);
+}
+
+TEST_CASE( "Test a pool of zero workers still runs", "[thread_pool]" )
+{
+  ThreadPool pool(0);
+  REQUIRE(pool.size() == 1);
+
+  int total = 0;
+  pool.parallel_for(10, [&total](std::size_t begin, std::size_t end){
+    total += static_cast<int>(end - begin);
+  });
+  REQUIRE(total == 10);
+}
@@ -0,0 +1,955 @@
+#include "vector_ops.hpp"
+#include "thread_pool.hpp"
+#include "cancellation.hpp"
+
+#include <cmath>
+#include <complex>
+#include <algorithm>
+#include <vector>
+
+/***********************************************************************
+Kernels over contiguous buffers. The __restrict qualifiers tell the
+compiler the buffers do not alias so the loops can be vectorized.
+**********************************************************************/
+
+static void add_vv(double * __restrict out, const double * __restrict x, std::size_t n){
+  for(std::size_t i = 0; i < n; i++) out[i] += x[i];
+}
+
+static void add_vs(double * __restrict out, double x, std::size_t n){
+  for(std::size_t i = 0; i < n; i++) out[i] += x;
+}
+
+static void sub_vv(double * __restrict out, const double * __restrict x, std::size_t n){
+  for(std::size_t i = 0; i < n; i++) out[i] -= x[i];
+}
+
+static void sub_vs(double * __restrict out, double x, std::size_t n){
+  for(std::size_t i = 0; i < n; i++) out[i] -= x;
+}
+
+static void mul_vv(double * __restrict out, const double * __restrict x, std::size_t n){
+  for(std::size_t i = 0; i < n; i++) out[i] *= x[i];
+}
+
+static void mul_vs(double * __restrict out, double x, std::size_t n){
+  for(std::size_t i = 0; i < n; i++) out[i] *= x;
+}
+
+static void div_vv(double * __restrict out, const double * __restrict x, std::size_t n){
+  for(std::size_t i = 0; i < n; i++) out[i] /= x[i];
+}
+
+static void div_vs(double * __restrict out, double x, std::size_t n){
+  for(std::size_t i = 0; i < n; i++) out[i] /= x;
+}
+
+static void neg_v(double * __restrict out, std::size_t n){
+  for(std::size_t i = 0; i < n; i++) out[i] = -out[i];
+}
+
+// (re + i*im) *= (xr + i*xi)
+static void cmul_vv(double * __restrict re, double * __restrict im,
+                    const double * __restrict xr, const double * __restrict xi, std::size_t n){
+  for(std::size_t i = 0; i < n; i++){
+    double r = re[i] * xr[i] - im[i] * xi[i];
+    double m = re[i] * xi[i] + im[i] * xr[i];
+    re[i] = r;
+    im[i] = m;
+  }
+}
+
+static void cmul_vs(double * __restrict re, double * __restrict im, double xr, double xi, std::size_t n){
+  for(std::size_t i = 0; i < n; i++){
+    double r = re[i] * xr - im[i] * xi;
+    double m = re[i] * xi + im[i] * xr;
+    re[i] = r;
+    im[i] = m;
+  }
+}
+
+// (re + i*im) /= (xr + i*xi), keeping plain real division for elements not
+// flagged Complex so that e.g. division by zero gives the same result as a
+// scalar Number division
+static void cdiv_vv(double * __restrict re, double * __restrict im,
+                    const double * __restrict xr, const double * __restrict xi,
+                    const unsigned char * __restrict flags, std::size_t n){
+  for(std::size_t i = 0; i < n; i++){
+    double d = xr[i] * xr[i] + xi[i] * xi[i];
+    double r = (re[i] * xr[i] + im[i] * xi[i]) / d;
+    double m = (im[i] * xr[i] - re[i] * xi[i]) / d;
+    double real = re[i] / xr[i];
+    re[i] = flags[i] ? r : real;
+    im[i] = flags[i] ? m : 0.0;
+  }
+}
+
+static void cdiv_vs(double * __restrict re, double * __restrict im, double xr, double xi, std::size_t n){
+  double d = xr * xr + xi * xi;
+  for(std::size_t i = 0; i < n; i++){
+    double r = (re[i] * xr + im[i] * xi) / d;
+    double m = (im[i] * xr - re[i] * xi) / d;
+    re[i] = r;
+    im[i] = m;
+  }
+}
+
+static void crecip_v(double * __restrict re, double * __restrict im,
+                     const unsigned char * __restrict flags, std::size_t n){
+  for(std::size_t i = 0; i < n; i++){
+    double d = re[i] * re[i] + im[i] * im[i];
+    double r = re[i] / d;
+    double m = -im[i] / d;
+    double real = 1.0 / re[i];
+    re[i] = flags[i] ? r : real;
+    im[i] = flags[i] ? m : 0.0;
+  }
+}
+
+// sqrt vectorizes to a hardware instruction. The transcendental kernels
+// below stay one scalar libm call per element, but still save the unpacking
+// and dispatch of a call per List entry
+static void sqrt_v(double * __restrict out, std::size_t n){
+  for(std::size_t i = 0; i < n; i++) out[i] = std::sqrt(out[i]);
+}
+
+static void log_v(double * __restrict out, std::size_t n){
+  for(std::size_t i = 0; i < n; i++) out[i] = std::log(out[i]);
+}
+
+static void sin_v(double * __restrict out, std::size_t n){
+  for(std::size_t i = 0; i < n; i++) out[i] = std::sin(out[i]);
+}
+
+static void cos_v(double * __restrict out, std::size_t n){
+  for(std::size_t i = 0; i < n; i++) out[i] = std::cos(out[i]);
+}
+
+static void tan_v(double * __restrict out, std::size_t n){
+  for(std::size_t i = 0; i < n; i++) out[i] = std::tan(out[i]);
+}
+
+static void pow_vv(double * __restrict out, const double * __restrict x, std::size_t n){
+  for(std::size_t i = 0; i < n; i++) out[i] = std::pow(out[i], x[i]);
+}
+
+static void pow_vs(double * __restrict out, double x, std::size_t n){
+  for(std::size_t i = 0; i < n; i++) out[i] = std::pow(out[i], x);
+}
+
+// Reductions keep four independent accumulators so the compiler can
+// vectorize them without reassociating a single running total
+static double sum_v(const double * __restrict x, std::size_t n){
+  double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+  std::size_t i = 0;
+  for(; i + 4 <= n; i += 4){
+    s0 += x[i]; s1 += x[i + 1]; s2 += x[i + 2]; s3 += x[i + 3];
+  }
+  for(; i < n; i++) s0 += x[i];
+  return (s0 + s1) + (s2 + s3);
+}
+
+static double prod_v(const double * __restrict x, std::size_t n){
+  double p0 = 1.0, p1 = 1.0, p2 = 1.0, p3 = 1.0;
+  std::size_t i = 0;
+  for(; i + 4 <= n; i += 4){
+    p0 *= x[i]; p1 *= x[i + 1]; p2 *= x[i + 2]; p3 *= x[i + 3];
+  }
+  for(; i < n; i++) p0 *= x[i];
+  return (p0 * p1) * (p2 * p3);
+}
+
+// n must be positive
+static double min_v(const double * __restrict x, std::size_t n){
+  double m0 = x[0], m1 = x[0], m2 = x[0], m3 = x[0];
+  std::size_t i = 0;
+  for(; i + 4 <= n; i += 4){
+    m0 = std::min(m0, x[i]); m1 = std::min(m1, x[i + 1]);
+    m2 = std::min(m2, x[i + 2]); m3 = std::min(m3, x[i + 3]);
+  }
+  for(; i < n; i++) m0 = std::min(m0, x[i]);
+  return std::min(std::min(m0, m1), std::min(m2, m3));
+}
+
+// n must be positive
+static double max_v(const double * __restrict x, std::size_t n){
+  double m0 = x[0], m1 = x[0], m2 = x[0], m3 = x[0];
+  std::size_t i = 0;
+  for(; i + 4 <= n; i += 4){
+    m0 = std::max(m0, x[i]); m1 = std::max(m1, x[i + 1]);
+    m2 = std::max(m2, x[i + 2]); m3 = std::max(m3, x[i + 3]);
+  }
+  for(; i < n; i++) m0 = std::max(m0, x[i]);
+  return std::max(std::max(m0, m1), std::max(m2, m3));
+}
+
+static double reduce_v(const double * x, std::size_t n, Reduction op){
+  switch(op){
+  case Reduction::Sum: return sum_v(x, n);
+  case Reduction::Product: return prod_v(x, n);
+  case Reduction::Min: return min_v(x, n);
+  case Reduction::Max: return max_v(x, n);
+  }
+  return 0.0;
+}
+
+// inputs longer than this are split into blocks of this many elements and
+// the blocks processed in parallel on the thread pool
+static const std::size_t BLOCK = 1 << 15;
+
+// Large inputs are split into blocks reduced in parallel on the thread
+// pool, and the block results are then reduced in turn
+static double reduce_tree(const std::vector<double> & x, Reduction op){
+
+  std::size_t n = x.size();
+
+  if(n <= BLOCK){
+    return reduce_v(x.data(), n, op);
+  }
+
+  std::size_t blocks = (n + BLOCK - 1) / BLOCK;
+  std::vector<double> partials(blocks);
+
+  // workers give up between blocks once interrupted; the caller then throws
+  const CancellationToken * token = CancellationToken::current();
+  ThreadPool::instance().parallel_for(blocks, [&](std::size_t begin, std::size_t end){
+    for(std::size_t b = begin; b < end; b++){
+      if(token && token->isCancelled()) return;
+      std::size_t first = b * BLOCK;
+      partials[b] = reduce_v(x.data() + first, std::min(BLOCK, n - first), op);
+    }
+  });
+  CancellationToken::check();
+
+  return reduce_tree(partials, op);
+}
+
+// mean and sum of squared deviations of a block, computed while the block
+// is in cache: the second loop re-reads memory the first just loaded
+static Moments moments_v(const double * __restrict x, std::size_t n){
+
+  Moments m;
+  m.count = n;
+  m.mean = sum_v(x, n) / n;
+
+  double d0 = 0.0, d1 = 0.0, d2 = 0.0, d3 = 0.0;
+  std::size_t i = 0;
+  for(; i + 4 <= n; i += 4){
+    double e0 = x[i] - m.mean, e1 = x[i + 1] - m.mean;
+    double e2 = x[i + 2] - m.mean, e3 = x[i + 3] - m.mean;
+    d0 += e0 * e0; d1 += e1 * e1; d2 += e2 * e2; d3 += e3 * e3;
+  }
+  for(; i < n; i++) d0 += (x[i] - m.mean) * (x[i] - m.mean);
+  m.m2 = (d0 + d1) + (d2 + d3);
+
+  return m;
+}
+
+// combine the moments of two disjoint blocks (Chan et al.)
+static Moments combine_moments(const Moments & a, const Moments & b){
+
+  if(a.count == 0) return b;
+  if(b.count == 0) return a;
+
+  Moments m;
+  m.count = a.count + b.count;
+  double delta = b.mean - a.mean;
+  m.mean = a.mean + delta * b.count / m.count;
+  m.m2 = a.m2 + b.m2 + delta * delta * (double(a.count) * b.count / m.count);
+
+  return m;
+}
+
+// count each element into one of bins equal-width bins over [lo, hi]
+static void histogram_v(const double * __restrict x, std::size_t n, double lo, double scale,
+                        std::size_t bins, std::size_t * __restrict counts){
+  for(std::size_t i = 0; i < n; i++){
+    std::size_t b = static_cast<std::size_t>((x[i] - lo) * scale);
+    counts[std::min(b, bins - 1)]++;
+  }
+}
+
+// true if any element is flagged Complex
+static bool any_flagged(const PackedArray & acc){
+
+  if(!acc.anyComplex) return false;
+
+  unsigned char flagged = 0;
+  for(std::size_t i = 0; i < acc.size(); i++) flagged |= acc.complex[i];
+  return flagged != 0;
+}
+
+// true if any real part is negative
+static bool any_negative(const double * __restrict x, std::size_t n){
+  bool negative = false;
+  for(std::size_t i = 0; i < n; i++) negative |= (x[i] < 0);
+  return negative;
+}
+
+// the result of an operation is Complex wherever either operand is
+static void merge_flags(PackedArray & acc, const PackedArray & x){
+
+  if(!x.anyComplex) return;
+
+  acc.makeComplex();
+  if(x.broadcast){
+    acc.complex.assign(acc.size(), 1);
+  }
+  else{
+    for(std::size_t i = 0; i < acc.size(); i++) acc.complex[i] |= x.complex[i];
+  }
+}
+
+/***********************************************************************
+Fourier Transform Kernels over contiguous complex buffers
+**********************************************************************/
+
+typedef std::complex<double> Cplx;
+
+static const double TAU = 2.0 * std::atan2(0.0, -1.0);
+
+// prime factors larger than this are transformed with Bluestein's algorithm
+// rather than as a direct O(p^2) DFT
+static const std::size_t DIRECT_DFT_MAX = 64;
+
+static bool is_power_of_two(std::size_t n){
+  return (n != 0) && ((n & (n - 1)) == 0);
+}
+
+static std::size_t smallest_factor(std::size_t n){
+  for(std::size_t p = 2; p * p <= n; p++){
+    if(n % p == 0) return p;
+  }
+  return n;
+}
+
+// in-place iterative radix-2 transform, n a power of two
+static void fft_radix2(Cplx * x, std::size_t n, bool inverse){
+
+  for(std::size_t i = 1, j = 0; i < n; i++){
+    std::size_t bit = n >> 1;
+    for(; j & bit; bit >>= 1) j ^= bit;
+    j ^= bit;
+    if(i < j) std::swap(x[i], x[j]);
+  }
+
+  double sign = inverse ? 1.0 : -1.0;
+  std::vector<Cplx> twiddle;
+  for(std::size_t len = 2; len <= n; len <<= 1){
+    CancellationToken::check();
+    std::size_t half = len / 2;
+    twiddle.resize(half);
+    for(std::size_t k = 0; k < half; k++){
+      twiddle[k] = std::polar(1.0, sign * TAU * k / len);
+    }
+
+    for(std::size_t i = 0; i < n; i += len){
+      for(std::size_t k = 0; k < half; k++){
+        Cplx u = x[i + k];
+        Cplx v = x[i + k + half] * twiddle[k];
+        x[i + k] = u + v;
+        x[i + k + half] = u - v;
+      }
+    }
+  }
+}
+
+static void fft_any(const Cplx * in, std::size_t stride, Cplx * out, std::size_t n, bool inverse);
+
+// transform of a prime length n by Bluestein's algorithm, which rewrites it
+// as a convolution computed with power of two transforms
+static void fft_bluestein(const Cplx * in, std::size_t stride, Cplx * out, std::size_t n, bool inverse){
+
+  std::size_t m = 1;
+  while(m < 2 * n - 1) m <<= 1;
+
+  // chirp[k] = exp(-+ pi i k^2 / n), with k^2 reduced mod 2n to keep the
+  // angles small
+  double sign = inverse ? 1.0 : -1.0;
+  std::vector<Cplx> chirp(n);
+  for(std::size_t k = 0; k < n; k++){
+    std::size_t k2 = (k * k) % (2 * n);
+    chirp[k] = std::polar(1.0, sign * TAU * k2 / (2.0 * n));
+  }
+
+  std::vector<Cplx> a(m, Cplx(0.0, 0.0)), b(m, Cplx(0.0, 0.0));
+  for(std::size_t k = 0; k < n; k++){
+    a[k] = in[k * stride] * chirp[k];
+  }
+  b[0] = std::conj(chirp[0]);
+  for(std::size_t k = 1; k < n; k++){
+    b[k] = b[m - k] = std::conj(chirp[k]);
+  }
+
+  fft_radix2(a.data(), m, false);
+  fft_radix2(b.data(), m, false);
+  for(std::size_t k = 0; k < m; k++){
+    a[k] *= b[k];
+  }
+  fft_radix2(a.data(), m, true);
+
+  for(std::size_t k = 0; k < n; k++){
+    out[k] = chirp[k] * a[k] / static_cast<double>(m);
+  }
+}
+
+// out-of-place mixed-radix transform of the n elements in[0], in[stride],
+// ..., unnormalized in either direction
+static void fft_any(const Cplx * in, std::size_t stride, Cplx * out, std::size_t n, bool inverse){
+
+  if(n == 1){
+    out[0] = in[0];
+    return;
+  }
+
+  if(is_power_of_two(n)){
+    for(std::size_t k = 0; k < n; k++) out[k] = in[k * stride];
+    fft_radix2(out, n, inverse);
+    return;
+  }
+
+  double sign = inverse ? 1.0 : -1.0;
+  std::size_t p = smallest_factor(n);
+
+  if(p == n){
+    if(n > DIRECT_DFT_MAX){
+      fft_bluestein(in, stride, out, n, inverse);
+      return;
+    }
+    for(std::size_t k = 0; k < n; k++){
+      Cplx sum(0.0, 0.0);
+      for(std::size_t j = 0; j < n; j++){
+        sum += in[j * stride] * std::polar(1.0, sign * TAU * ((j * k) % n) / n);
+      }
+      out[k] = sum;
+    }
+    return;
+  }
+
+  // transform the p interleaved subsequences of length m, then combine
+  // them with p-point butterflies
+  std::size_t m = n / p;
+  for(std::size_t r = 0; r < p; r++){
+    fft_any(in + r * stride, stride * p, out + r * m, m, inverse);
+  }
+  CancellationToken::check();
+
+  std::vector<Cplx> twiddle(n);
+  for(std::size_t j = 0; j < n; j++){
+    twiddle[j] = std::polar(1.0, sign * TAU * j / n);
+  }
+
+  std::vector<Cplx> column(p);
+  for(std::size_t k = 0; k < m; k++){
+    for(std::size_t r = 0; r < p; r++){
+      column[r] = out[r * m + k];
+    }
+    for(std::size_t q = 0; q < p; q++){
+      std::size_t index = k + q * m;
+      Cplx sum(0.0, 0.0);
+      for(std::size_t r = 0; r < p; r++){
+        sum += column[r] * twiddle[(r * index) % n];
+      }
+      out[index] = sum;
+    }
+  }
+}
+
+/***********************************************************************
+PackedArray Methods
+**********************************************************************/
+
+std::size_t PackedArray::size() const noexcept{
+  return re.size();
+}
+
+void PackedArray::makeComplex(){
+
+  if(!anyComplex){
+    im.assign(re.size(), 0.0);
+    complex.assign(re.size(), 0);
+    anyComplex = true;
+  }
+}
+
+void PackedArray::expand(std::size_t n){
+
+  if(broadcast){
+    re.assign(n, re[0]);
+    if(anyComplex){
+      im.assign(n, im[0]);
+      complex.assign(n, complex[0]);
+    }
+    broadcast = false;
+  }
+}
+
+/***********************************************************************
+Conversion To and From Expressions
+**********************************************************************/
+
+bool pack(const Expression & exp, PackedArray & out){
+
+  out = PackedArray();
+
+  if(exp.isHeadNumber()){
+    out.re.push_back(exp.head().asNumber());
+    out.broadcast = true;
+    return true;
+  }
+  else if(exp.isHeadComplex()){
+    out.re.push_back(exp.head().asComplex().real());
+    out.makeComplex();
+    out.im[0] = exp.head().asComplex().imag();
+    out.complex[0] = 1;
+    out.broadcast = true;
+    return true;
+  }
+  else if(!exp.isHeadList()){
+    return false;
+  }
+
+  // read entries one at a time so a lazy range is never materialized
+  std::size_t n = exp.listSize();
+  out.re.resize(n);
+
+  for(std::size_t i = 0; i < n; i++){
+    if(i % BLOCK == 0) CancellationToken::check();
+
+    Expression item = exp.listAt(i);
+    const Atom & a = item.head();
+
+    if(!item.isTailEmpty()){
+      return false;
+    }
+    else if(a.isNumber()){
+      out.re[i] = a.asNumber();
+    }
+    else if(a.isComplex()){
+      out.makeComplex();
+      out.re[i] = a.asComplex().real();
+      out.im[i] = a.asComplex().imag();
+      out.complex[i] = 1;
+    }
+    else{
+      return false;
+    }
+  }
+
+  return true;
+}
+
+Expression unpack(const PackedArray & values){
+
+  Expression::List items;
+  items.reserve(values.size());
+
+  for(std::size_t i = 0; i < values.size(); i++){
+    if(i % BLOCK == 0) CancellationToken::check();
+
+    if(values.anyComplex && values.complex[i]){
+      items.emplace_back(Atom(std::complex<double>(values.re[i], values.im[i])));
+    }
+    else{
+      items.emplace_back(Atom(values.re[i]));
+    }
+  }
+
+  return Expression(items);
+}
+
+/***********************************************************************
+Element-Wise Operations
+**********************************************************************/
+
+void packedAdd(PackedArray & acc, const PackedArray & x){
+
+  std::size_t n = acc.size();
+
+  if(x.broadcast) add_vs(acc.re.data(), x.re[0], n);
+  else add_vv(acc.re.data(), x.re.data(), n);
+
+  if(x.anyComplex){
+    merge_flags(acc, x);
+    if(x.broadcast) add_vs(acc.im.data(), x.im[0], n);
+    else add_vv(acc.im.data(), x.im.data(), n);
+  }
+}
+
+void packedSub(PackedArray & acc, const PackedArray & x){
+
+  std::size_t n = acc.size();
+
+  if(x.broadcast) sub_vs(acc.re.data(), x.re[0], n);
+  else sub_vv(acc.re.data(), x.re.data(), n);
+
+  if(x.anyComplex){
+    merge_flags(acc, x);
+    if(x.broadcast) sub_vs(acc.im.data(), x.im[0], n);
+    else sub_vv(acc.im.data(), x.im.data(), n);
+  }
+}
+
+void packedMul(PackedArray & acc, const PackedArray & x){
+
+  std::size_t n = acc.size();
+
+  if(!x.anyComplex){
+    // a real factor scales both parts
+    if(x.broadcast) mul_vs(acc.re.data(), x.re[0], n);
+    else mul_vv(acc.re.data(), x.re.data(), n);
+
+    if(acc.anyComplex){
+      if(x.broadcast) mul_vs(acc.im.data(), x.re[0], n);
+      else mul_vv(acc.im.data(), x.re.data(), n);
+    }
+  }
+  else{
+    merge_flags(acc, x);
+    if(x.broadcast) cmul_vs(acc.re.data(), acc.im.data(), x.re[0], x.im[0], n);
+    else cmul_vv(acc.re.data(), acc.im.data(), x.re.data(), x.im.data(), n);
+  }
+}
+
+void packedDiv(PackedArray & acc, const PackedArray & x){
+
+  std::size_t n = acc.size();
+
+  if(!x.anyComplex){
+    // a real divisor scales both parts
+    if(x.broadcast) div_vs(acc.re.data(), x.re[0], n);
+    else div_vv(acc.re.data(), x.re.data(), n);
+
+    if(acc.anyComplex){
+      if(x.broadcast) div_vs(acc.im.data(), x.re[0], n);
+      else div_vv(acc.im.data(), x.re.data(), n);
+    }
+  }
+  else{
+    merge_flags(acc, x);
+    if(x.broadcast) cdiv_vs(acc.re.data(), acc.im.data(), x.re[0], x.im[0], n);
+    else cdiv_vv(acc.re.data(), acc.im.data(), x.re.data(), x.im.data(), acc.complex.data(), n);
+  }
+}
+
+bool packedPow(PackedArray & acc, const PackedArray & x){
+
+  std::size_t n = acc.size();
+  merge_flags(acc, x);
+
+  auto xr = [&x](std::size_t i){ return x.broadcast ? x.re[0] : x.re[i]; };
+  auto xi = [&x](std::size_t i){ return !x.anyComplex ? 0.0 : (x.broadcast ? x.im[0] : x.im[i]); };
+
+  // as with Numbers, a real power needs a non-negative base and a positive exponent
+  bool invalid = false;
+  for(std::size_t i = 0; i < n; i++){
+    bool real = !acc.anyComplex || !acc.complex[i];
+    invalid |= real && ((acc.re[i] < 0) || (xr(i) <= 0));
+  }
+  if(invalid) return false;
+
+  if(!acc.anyComplex){
+    if(x.broadcast) pow_vs(acc.re.data(), x.re[0], n);
+    else pow_vv(acc.re.data(), x.re.data(), n);
+    return true;
+  }
+
+  for(std::size_t i = 0; i < n; i++){
+    if(acc.complex[i]){
+      std::complex<double> z = std::pow(std::complex<double>(acc.re[i], acc.im[i]),
+                                        std::complex<double>(xr(i), xi(i)));
+      acc.re[i] = z.real();
+      acc.im[i] = z.imag();
+    }
+    else{
+      acc.re[i] = std::pow(acc.re[i], xr(i));
+    }
+  }
+  return true;
+}
+
+void packedNeg(PackedArray & acc){
+
+  neg_v(acc.re.data(), acc.size());
+
+  if(acc.anyComplex){
+    neg_v(acc.im.data(), acc.size());
+  }
+}
+
+void packedRecip(PackedArray & acc){
+
+  if(!acc.anyComplex){
+    PackedArray one;
+    one.re.assign(acc.size(), 1.0);
+    std::swap(one.re, acc.re);
+    div_vv(acc.re.data(), one.re.data(), acc.size());
+  }
+  else{
+    crecip_v(acc.re.data(), acc.im.data(), acc.complex.data(), acc.size());
+  }
+}
+
+bool packedSqrt(PackedArray & acc){
+
+  std::size_t n = acc.size();
+  bool negative = any_negative(acc.re.data(), n);
+
+  if(!acc.anyComplex && !negative){
+    sqrt_v(acc.re.data(), n);
+    return true;
+  }
+
+  // negative Numbers have Complex roots
+  acc.makeComplex();
+  for(std::size_t i = 0; i < n; i++){
+    if(acc.complex[i] || (acc.re[i] < 0)){
+      std::complex<double> z = std::sqrt(std::complex<double>(acc.re[i], acc.im[i]));
+      acc.re[i] = z.real();
+      acc.im[i] = z.imag();
+      acc.complex[i] = 1;
+    }
+    else{
+      acc.re[i] = std::sqrt(acc.re[i]);
+    }
+  }
+  return true;
+}
+
+bool packedLog(PackedArray & acc){
+
+  if(any_flagged(acc) || any_negative(acc.re.data(), acc.size())) return false;
+
+  log_v(acc.re.data(), acc.size());
+  return true;
+}
+
+bool packedSin(PackedArray & acc){
+
+  if(any_flagged(acc)) return false;
+
+  sin_v(acc.re.data(), acc.size());
+  return true;
+}
+
+bool packedCos(PackedArray & acc){
+
+  if(any_flagged(acc)) return false;
+
+  cos_v(acc.re.data(), acc.size());
+  return true;
+}
+
+bool packedTan(PackedArray & acc){
+
+  if(any_flagged(acc)) return false;
+
+  tan_v(acc.re.data(), acc.size());
+  return true;
+}
+
+bool packedReduce(const PackedArray & values, Reduction op, Expression & result){
+
+  if(values.size() == 0) return false;
+
+  if(!any_flagged(values)){
+    result = Expression(Atom(reduce_tree(values.re, op)));
+    return true;
+  }
+
+  // only a sum splits into independent real and imaginary parts
+  if(op != Reduction::Sum) return false;
+
+  result = Expression(Atom(std::complex<double>(reduce_tree(values.re, op), reduce_tree(values.im, op))));
+  return true;
+}
+
+Moments packedMoments(const PackedArray & values){
+
+  std::size_t n = values.size();
+  const double * x = values.re.data();
+
+  if(n <= BLOCK){
+    return (n == 0) ? Moments() : moments_v(x, n);
+  }
+
+  std::size_t blocks = (n + BLOCK - 1) / BLOCK;
+  std::vector<Moments> partials(blocks);
+
+  const CancellationToken * token = CancellationToken::current();
+  ThreadPool::instance().parallel_for(blocks, [&](std::size_t begin, std::size_t end){
+    for(std::size_t b = begin; b < end; b++){
+      if(token && token->isCancelled()) return;
+      std::size_t first = b * BLOCK;
+      partials[b] = moments_v(x + first, std::min(BLOCK, n - first));
+    }
+  });
+  CancellationToken::check();
+
+  Moments result;
+  for(auto & m : partials){
+    result = combine_moments(result, m);
+  }
+  return result;
+}
+
+std::vector<std::size_t> packedHistogram(const PackedArray & values, double lo, double hi, std::size_t bins){
+
+  std::size_t n = values.size();
+  const double * x = values.re.data();
+
+  // a zero-width range puts everything in the first bin
+  double scale = (hi > lo) ? bins / (hi - lo) : 0.0;
+
+  if(n <= BLOCK){
+    std::vector<std::size_t> counts(bins, 0);
+    histogram_v(x, n, lo, scale, bins, counts.data());
+    return counts;
+  }
+
+  // each block counts into its own row, merged once all are done
+  std::size_t blocks = (n + BLOCK - 1) / BLOCK;
+  std::vector<std::size_t> rows(blocks * bins, 0);
+
+  const CancellationToken * token = CancellationToken::current();
+  ThreadPool::instance().parallel_for(blocks, [&](std::size_t begin, std::size_t end){
+    for(std::size_t b = begin; b < end; b++){
+      if(token && token->isCancelled()) return;
+      std::size_t first = b * BLOCK;
+      histogram_v(x + first, std::min(BLOCK, n - first), lo, scale, bins, rows.data() + b * bins);
+    }
+  });
+  CancellationToken::check();
+
+  std::vector<std::size_t> counts(bins, 0);
+  for(std::size_t b = 0; b < blocks; b++){
+    for(std::size_t i = 0; i < bins; i++){
+      counts[i] += rows[b * bins + i];
+    }
+  }
+  return counts;
+}
+
+/***********************************************************************
+Signal Processing
+**********************************************************************/
+
+void packedFFT(PackedArray & values, bool inverse){
+
+  std::size_t n = values.size();
+  if(n == 0) return;
+
+  values.makeComplex();
+
+  std::vector<Cplx> in(n), out(n);
+  for(std::size_t i = 0; i < n; i++){
+    in[i] = Cplx(values.re[i], values.im[i]);
+  }
+
+  fft_any(in.data(), 1, out.data(), n, inverse);
+
+  double scale = inverse ? 1.0 / n : 1.0;
+  for(std::size_t i = 0; i < n; i++){
+    values.re[i] = out[i].real() * scale;
+    values.im[i] = out[i].imag() * scale;
+    values.complex[i] = 1;
+  }
+}
+
+// convolutions with fewer multiply-adds than this are computed directly
+static const std::size_t DIRECT_CONVOLVE_MAX = 1 << 16;
+
+// out += a * b, full linear convolution of two real buffers
+static void convolve_v(double * __restrict out, const double * __restrict a, std::size_t n,
+                       const double * __restrict b, std::size_t m, double sign){
+  for(std::size_t i = 0; i < n; i++){
+    double ai = sign * a[i];
+    for(std::size_t j = 0; j < m; j++) out[i + j] += ai * b[j];
+  }
+}
+
+void packedConvolve(const PackedArray & a, const PackedArray & b, PackedArray & out){
+
+  std::size_t n = a.size();
+  std::size_t m = b.size();
+  std::size_t size = n + m - 1;
+  bool complex = any_flagged(a) || any_flagged(b);
+
+  out = PackedArray();
+  out.re.assign(size, 0.0);
+  if(complex){
+    out.makeComplex();
+    out.complex.assign(size, 1);
+  }
+
+  if(n * m <= DIRECT_CONVOLVE_MAX){
+    convolve_v(out.re.data(), a.re.data(), n, b.re.data(), m, 1.0);
+    if(complex){
+      const double * aIm = a.anyComplex ? a.im.data() : nullptr;
+      const double * bIm = b.anyComplex ? b.im.data() : nullptr;
+      if(aIm && bIm) convolve_v(out.re.data(), aIm, n, bIm, m, -1.0);
+      if(bIm) convolve_v(out.im.data(), a.re.data(), n, bIm, m, 1.0);
+      if(aIm) convolve_v(out.im.data(), aIm, n, b.re.data(), m, 1.0);
+    }
+    return;
+  }
+
+  // pointwise product of the transforms, zero-padded to a power of two
+  std::size_t len = 1;
+  while(len < size) len <<= 1;
+
+  std::vector<Cplx> fa(len, Cplx(0.0, 0.0)), fb(len, Cplx(0.0, 0.0));
+  for(std::size_t i = 0; i < n; i++){
+    fa[i] = Cplx(a.re[i], a.anyComplex ? a.im[i] : 0.0);
+  }
+  for(std::size_t i = 0; i < m; i++){
+    fb[i] = Cplx(b.re[i], b.anyComplex ? b.im[i] : 0.0);
+  }
+
+  fft_radix2(fa.data(), len, false);
+  fft_radix2(fb.data(), len, false);
+  for(std::size_t k = 0; k < len; k++){
+    fa[k] *= fb[k];
+  }
+  fft_radix2(fa.data(), len, true);
+
+  for(std::size_t i = 0; i < size; i++){
+    out.re[i] = fa[i].real() / len;
+    if(complex) out.im[i] = fa[i].imag() / len;
+  }
+}
+
+// out[k] = mean of x[k .. k + width - 1]; the running sum is recomputed
+// from scratch every width outputs so rounding errors cannot build up
+static void moving_average_v(double * __restrict out, const double * __restrict x,
+                             std::size_t n, std::size_t width){
+  std::size_t count = n - width + 1;
+  double sum = 0.0;
+  for(std::size_t k = 0; k < count; k++){
+    if(k % width == 0){
+      sum = 0.0;
+      for(std::size_t j = k; j < k + width; j++) sum += x[j];
+    }
+    else{
+      sum += x[k + width - 1] - x[k - 1];
+    }
+    out[k] = sum / width;
+  }
+}
+
+void packedMovingAverage(const PackedArray & values, std::size_t width, PackedArray & out){
+
+  std::size_t n = values.size();
+  std::size_t count = n - width + 1;
+  bool complex = any_flagged(values);
+
+  out = PackedArray();
+  out.re.resize(count);
+  moving_average_v(out.re.data(), values.re.data(), n, width);
+
+  if(complex){
+    out.makeComplex();
+    out.complex.assign(count, 1);
+    moving_average_v(out.im.data(), values.im.data(), n, width);
+  }
+}
@@ -0,0 +1,168 @@
+/*! \file vector_ops.hpp
+Defines the packed numeric array type and the element-wise kernels used by
+the built-in procedures when they operate over Lists.
+
+The kernels are written as plain loops over contiguous, non-aliased double
+buffers so the compiler can vectorize them (SSE2/AVX2 on x86). That covers
+the arithmetic, the reductions and sqrt. ln, sin, cos, tan and ^ are scalar
+libm calls made in a loop over the packed buffer: glibc only provides
+vector variants of them under -ffast-math, which the build does not use.
+ */
+#ifndef VECTOR_OPS_HPP
+#define VECTOR_OPS_HPP
+
+#include "expression.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/*! \struct PackedArray
+\brief A List of Number and Complex values as a structure-of-arrays.
+
+The real and imaginary parts are stored in separate buffers. The imaginary
+buffer and the per-element Complex flags are only allocated once a Complex
+value is involved, so purely real work never touches them. A broadcast
+array holds a single value that stands for every element of a List.
+ */
+struct PackedArray {
+
+  std::vector<double> re;             // real parts
+  std::vector<double> im;             // imaginary parts, when anyComplex
+  std::vector<unsigned char> complex; // per-element Complex flag, when anyComplex
+
+  bool anyComplex = false; // true if any element is Complex
+  bool broadcast = false;  // true if this is a scalar standing for a List
+
+  /// number of elements stored
+  std::size_t size() const noexcept;
+
+  /// allocate the imaginary parts and flags (all zero) if not present
+  void makeComplex();
+
+  /// replicate a broadcast scalar into n stored elements
+  void expand(std::size_t n);
+};
+
+/*! Pack a Number, a Complex, or a List of them.
+  \param exp the Expression to pack, a scalar is packed as a broadcast array
+  \param out the array to fill
+  \return false if exp (or any List element) is not a Number or Complex
+ */
+bool pack(const Expression & exp, PackedArray & out);
+
+/*! Unpack into a List of Number or Complex Expressions.
+  \param values the array to unpack (not broadcast)
+  \return a List with one entry per element, Complex where flagged
+ */
+Expression unpack(const PackedArray & values);
+
+/// acc[i] = acc[i] + x[i], x may be broadcast
+void packedAdd(PackedArray & acc, const PackedArray & x);
+
+/// acc[i] = acc[i] - x[i], x may be broadcast
+void packedSub(PackedArray & acc, const PackedArray & x);
+
+/// acc[i] = acc[i] * x[i], x may be broadcast
+void packedMul(PackedArray & acc, const PackedArray & x);
+
+/// acc[i] = acc[i] / x[i], x may be broadcast
+void packedDiv(PackedArray & acc, const PackedArray & x);
+
+/*! acc[i] = acc[i] ^ x[i], x may be broadcast
+  \return false, leaving acc unspecified, if a pair of Numbers is outside
+  the domain of a real power (a negative base or non-positive exponent)
+ */
+bool packedPow(PackedArray & acc, const PackedArray & x);
+
+/// acc[i] = -acc[i]
+void packedNeg(PackedArray & acc);
+
+/// acc[i] = 1 / acc[i]
+void packedRecip(PackedArray & acc);
+
+/*! The transcendental functions below validate the whole array before
+  computing anything. Each returns false, leaving acc unchanged, if any
+  element is outside the domain of the corresponding scalar procedure.
+ */
+
+/// acc[i] = sqrt(acc[i]), negative Numbers give Complex roots, never fails
+bool packedSqrt(PackedArray & acc);
+
+/// acc[i] = ln(acc[i]), fails on negative or Complex elements
+bool packedLog(PackedArray & acc);
+
+/// acc[i] = sin(acc[i]), fails on Complex elements
+bool packedSin(PackedArray & acc);
+
+/// acc[i] = cos(acc[i]), fails on Complex elements
+bool packedCos(PackedArray & acc);
+
+/// acc[i] = tan(acc[i]), fails on Complex elements
+bool packedTan(PackedArray & acc);
+
+/// the associative operations packedReduce evaluates natively
+enum class Reduction { Sum, Product, Min, Max };
+
+/*! Combine every element with an associative operation, as a parallel tree
+  reduction for large arrays. Results may differ from a left-to-right
+  evaluation in the last bits, as the additions and multiplications are
+  regrouped.
+  \param values the (non-broadcast) array to reduce
+  \param op the operation to combine elements with
+  \param result set to the Number, or for a Sum with Complex elements the
+  Complex, result
+  \return false if values is empty, or has Complex elements and op is not a Sum
+ */
+bool packedReduce(const PackedArray & values, Reduction op, Expression & result);
+
+/// the size, mean and sum of squared deviations from the mean of an array
+struct Moments {
+  std::size_t count = 0;
+  double mean = 0.0;
+  double m2 = 0.0;
+};
+
+/*! Compute the moments of the real parts of an array in one pass over
+  memory, in parallel blocks for large arrays.
+  \param values the (non-broadcast) array to summarize
+  \return the moments, all zero for an empty array
+ */
+Moments packedMoments(const PackedArray & values);
+
+/*! Count the real parts of an array into equal-width bins.
+  \param values the (non-broadcast) array to count, every real part finite
+  \param lo the lower edge of the first bin, no greater than any element
+  \param hi the upper edge of the last bin, no less than any element
+  \param bins the number of bins (positive)
+  \return the count in each bin, elements equal to hi are in the last bin
+ */
+std::vector<std::size_t> packedHistogram(const PackedArray & values, double lo, double hi, std::size_t bins);
+
+/*! Discrete Fourier transform, X[k] = sum x[j] exp(-2 pi i j k / n), or for
+  the inverse, x[j] = (1/n) sum X[k] exp(2 pi i j k / n), in O(n log n) for
+  any length: radix-2 for powers of two, mixed-radix over the prime factors
+  otherwise, and Bluestein's algorithm for large prime factors.
+  \param values the (non-broadcast) array to transform in place, every
+  element of which becomes Complex
+  \param inverse true for the inverse transform
+ */
+void packedFFT(PackedArray & values, bool inverse);
+
+/*! Full linear convolution, out[k] = sum a[j] b[k - j], of length
+  a.size() + b.size() - 1, directly for short inputs and by FFT otherwise.
+  \param a the first (non-broadcast, non-empty) array
+  \param b the second (non-broadcast, non-empty) array
+  \param out set to the convolution, Complex only if a or b has a Complex
+  element
+ */
+void packedConvolve(const PackedArray & a, const PackedArray & b, PackedArray & out);
+
+/*! Means of each run of width consecutive elements, out[k] = (1/width)
+  sum x[k .. k + width - 1], of length values.size() - width + 1.
+  \param values the (non-broadcast) array to average
+  \param width the window width, from 1 to values.size()
+  \param out set to the means, Complex only if values has a Complex element
+ */
+void packedMovingAverage(const PackedArray & values, std::size_t width, PackedArray & out);
+
+#endif
@@ -0,0 +1,258 @@
+#include "catch.hpp"
+
+#include "vector_ops.hpp"
+
+#include <cmath>
+#include <complex>
+
+TEST_CASE( "Test packing Expressions", "[vector_ops]" )
+{
+  PackedArray values;
+
+  INFO("Scalars pack as broadcast arrays");
+  REQUIRE(pack(Expression(2.0), values));
+  REQUIRE(values.broadcast);
+  REQUIRE(!values.anyComplex);
+  REQUIRE(values.re[0] == 2.0);
+
+  REQUIRE(pack(Expression(Atom(std::complex<double>(1.0, 2.0))), values));
+  REQUIRE(values.broadcast);
+  REQUIRE(values.anyComplex);
+  REQUIRE(values.im[0] == 2.0);
+
+  INFO("Lists pack element by element and unpack to the same List");
+  Expression list(Expression::List{ Expression(1.0), Expression(Atom(std::complex<double>(0.0, 1.0))) });
+  REQUIRE(pack(list, values));
+  REQUIRE(!values.broadcast);
+  REQUIRE(values.size() == 2);
+  REQUIRE(values.complex[0] == 0);
+  REQUIRE(values.complex[1] == 1);
+  REQUIRE(unpack(values) == list);
+
+  INFO("Non-numeric values do not pack");
+  REQUIRE(!pack(Expression(Atom("foo")), values));
+  REQUIRE(!pack(Expression(Expression::List{ Expression(Atom("\"a\"")) }), values));
+  REQUIRE(!pack(Expression(Expression::List{ list }), values));
+}
+
+TEST_CASE( "Test element-wise kernels", "[vector_ops]" )
+{
+  PackedArray acc, x;
+  REQUIRE(pack(Expression(Expression::List{ Expression(1.0), Expression(2.0), Expression(4.0) }), acc));
+  REQUIRE(pack(Expression(2.0), x));
+
+  packedMul(acc, x);
+  REQUIRE(acc.re == std::vector<double>({2.0, 4.0, 8.0}));
+
+  packedSub(acc, x);
+  REQUIRE(acc.re == std::vector<double>({0.0, 2.0, 6.0}));
+
+  packedAdd(acc, acc);
+  REQUIRE(acc.re == std::vector<double>({0.0, 4.0, 12.0}));
+
+  packedDiv(acc, x);
+  REQUIRE(acc.re == std::vector<double>({0.0, 2.0, 6.0}));
+
+  packedNeg(acc);
+  REQUIRE(acc.re == std::vector<double>({-0.0, -2.0, -6.0}));
+
+  INFO("Complex operands promote every element they touch");
+  REQUIRE(pack(Expression(Atom(std::complex<double>(0.0, 1.0))), x));
+  packedMul(acc, x);
+  REQUIRE(acc.anyComplex);
+  REQUIRE(acc.im == std::vector<double>({-0.0, -2.0, -6.0}));
+
+  packedRecip(acc);
+  REQUIRE(acc.re[1] == Approx(0.0));
+  REQUIRE(acc.im[1] == Approx(0.5));
+}
+
+TEST_CASE( "Test transcendental kernels", "[vector_ops]" )
+{
+  PackedArray acc, x;
+  Expression list(Expression::List{ Expression(4.0), Expression(-4.0) });
+
+  INFO("Negative Numbers have Complex roots");
+  REQUIRE(pack(list, acc));
+  REQUIRE(packedSqrt(acc));
+  REQUIRE(acc.complex == std::vector<unsigned char>({0, 1}));
+  REQUIRE(acc.re[0] == 2.0);
+  REQUIRE(acc.im[1] == 2.0);
+
+  INFO("Domain errors are reported for the whole array");
+  REQUIRE(pack(list, acc));
+  REQUIRE(!packedLog(acc));
+  REQUIRE(acc.re == std::vector<double>({4.0, -4.0}));
+  REQUIRE(pack(list, acc));
+  REQUIRE(packedSin(acc));
+  REQUIRE(acc.re[0] == Approx(std::sin(4.0)));
+  REQUIRE(pack(Expression(Expression::List{ Expression(Atom(std::complex<double>(0.0, 1.0))) }), acc));
+  REQUIRE(!packedCos(acc));
+  REQUIRE(!packedTan(acc));
+
+  INFO("Real powers need a non-negative base and a positive exponent");
+  REQUIRE(pack(list, acc));
+  REQUIRE(pack(Expression(2.0), x));
+  REQUIRE(!packedPow(acc, x));
+  REQUIRE(pack(Expression(Expression::List{ Expression(2.0), Expression(3.0) }), acc));
+  REQUIRE(packedPow(acc, x));
+  REQUIRE(acc.re == std::vector<double>({4.0, 9.0}));
+  REQUIRE(pack(Expression(Atom(std::complex<double>(2.0, 0.0))), x));
+  REQUIRE(packedPow(acc, x));
+  REQUIRE(acc.complex == std::vector<unsigned char>({1, 1}));
+  REQUIRE(acc.re[1] == Approx(81.0));
+}
+
+TEST_CASE( "Test reductions", "[vector_ops]" )
+{
+  PackedArray values;
+  Expression result;
+
+  REQUIRE(pack(Expression(Expression::List{ Expression(3.0), Expression(-1.0), Expression(2.0),
+                                            Expression(5.0), Expression(4.0) }), values));
+  REQUIRE(packedReduce(values, Reduction::Sum, result));
+  REQUIRE(result == Expression(13.0));
+  REQUIRE(packedReduce(values, Reduction::Product, result));
+  REQUIRE(result == Expression(-120.0));
+  REQUIRE(packedReduce(values, Reduction::Min, result));
+  REQUIRE(result == Expression(-1.0));
+  REQUIRE(packedReduce(values, Reduction::Max, result));
+  REQUIRE(result == Expression(5.0));
+
+  INFO("only sums have a native form with Complex elements");
+  REQUIRE(pack(Expression(Expression::List{ Expression(1.0), Expression(Atom(std::complex<double>(1.0, 2.0))) }), values));
+  REQUIRE(packedReduce(values, Reduction::Sum, result));
+  REQUIRE(result == Expression(Atom(std::complex<double>(2.0, 2.0))));
+  REQUIRE(!packedReduce(values, Reduction::Max, result));
+
+  INFO("large arrays are reduced block by block on the thread pool");
+  REQUIRE(pack(Expression::makeRange(1.0, 200000.0, 1.0, 200000), values));
+  REQUIRE(packedReduce(values, Reduction::Sum, result));
+  REQUIRE(result == Expression(200000.0 * 200001.0 / 2));
+  REQUIRE(packedReduce(values, Reduction::Max, result));
+  REQUIRE(result == Expression(200000.0));
+
+  REQUIRE(!packedReduce(PackedArray(), Reduction::Sum, result));
+}
+
+TEST_CASE( "Test moments and histograms", "[vector_ops]" )
+{
+  PackedArray values;
+
+  REQUIRE(pack(Expression(Expression::List{ Expression(2.0), Expression(4.0), Expression(4.0), Expression(4.0),
+                                            Expression(5.0), Expression(5.0), Expression(7.0), Expression(9.0) }), values));
+  Moments m = packedMoments(values);
+  REQUIRE(m.count == 8);
+  REQUIRE(m.mean == Approx(5.0));
+  REQUIRE(m.m2 == Approx(32.0));
+
+  REQUIRE(packedHistogram(values, 2.0, 9.0, 7) == std::vector<std::size_t>({1, 0, 3, 2, 0, 1, 1}));
+
+  INFO("large arrays are split into blocks whose partial results are merged");
+  REQUIRE(pack(Expression::makeRange(1.0, 200000.0, 1.0, 200000), values));
+  m = packedMoments(values);
+  REQUIRE(m.count == 200000);
+  REQUIRE(m.mean == Approx(100000.5));
+  REQUIRE(m.m2 / m.count == Approx((200000.0 * 200000.0 - 1) / 12));
+
+  std::vector<std::size_t> counts = packedHistogram(values, 1.0, 200000.0, 4);
+  REQUIRE(counts == std::vector<std::size_t>({50000, 50000, 50000, 50000}));
+}
+
+// direct O(n^2) transform to check the fast paths against
+static std::vector<std::complex<double>> naiveDFT(const std::vector<std::complex<double>> & x, bool inverse)
+{
+  const double tau = 2.0 * std::atan2(0.0, -1.0);
+  std::size_t n = x.size();
+  std::vector<std::complex<double>> out(n);
+  for(std::size_t k = 0; k < n; k++){
+    for(std::size_t j = 0; j < n; j++){
+      out[k] += x[j] * std::polar(1.0, (inverse ? 1.0 : -1.0) * tau * ((j * k) % n) / n);
+    }
+    if(inverse) out[k] /= static_cast<double>(n);
+  }
+  return out;
+}
+
+TEST_CASE( "Test Fourier transforms", "[vector_ops]" )
+{
+  INFO("radix-2, mixed-radix, small prime and Bluestein lengths all match the direct transform");
+  for(std::size_t n : {1, 2, 8, 12, 30, 7, 67, 134, 256}){
+    INFO(n);
+    std::vector<std::complex<double>> x(n);
+    PackedArray values;
+    values.re.resize(n);
+    values.makeComplex();
+    for(std::size_t i = 0; i < n; i++){
+      x[i] = std::complex<double>(std::sin(0.3 * i) + i % 5, std::cos(0.7 * i));
+      values.re[i] = x[i].real();
+      values.im[i] = x[i].imag();
+      values.complex[i] = 1;
+    }
+
+    std::vector<std::complex<double>> expected = naiveDFT(x, false);
+    packedFFT(values, false);
+    for(std::size_t k = 0; k < n; k++){
+      REQUIRE(std::abs(values.re[k] - expected[k].real()) < 1e-9);
+      REQUIRE(std::abs(values.im[k] - expected[k].imag()) < 1e-9);
+    }
+
+    packedFFT(values, true);
+    for(std::size_t k = 0; k < n; k++){
+      REQUIRE(std::abs(values.re[k] - x[k].real()) < 1e-9);
+      REQUIRE(std::abs(values.im[k] - x[k].imag()) < 1e-9);
+    }
+  }
+
+  INFO("the transform of real data is flagged Complex");
+  PackedArray values;
+  REQUIRE(pack(Expression(Expression::List{ Expression(1.0), Expression(1.0) }), values));
+  packedFFT(values, false);
+  REQUIRE(values.anyComplex);
+  REQUIRE(values.complex == std::vector<unsigned char>({1, 1}));
+  REQUIRE(values.re == std::vector<double>({2.0, 0.0}));
+}
+
+TEST_CASE( "Test convolution and moving averages", "[vector_ops]" )
+{
+  PackedArray a, b, out;
+
+  REQUIRE(pack(Expression(Expression::List{ Expression(1.0), Expression(2.0), Expression(3.0) }), a));
+  REQUIRE(pack(Expression(Expression::List{ Expression(0.0), Expression(1.0), Expression(0.5) }), b));
+  packedConvolve(a, b, out);
+  REQUIRE(!out.anyComplex);
+  REQUIRE(out.re == std::vector<double>({0.0, 1.0, 2.5, 4.0, 1.5}));
+
+  INFO("complex inputs give a complex result");
+  REQUIRE(pack(Expression(Expression::List{ Expression(Atom(std::complex<double>(0.0, 1.0))) }), b));
+  packedConvolve(a, b, out);
+  REQUIRE(out.anyComplex);
+  REQUIRE(out.re == std::vector<double>({0.0, 0.0, 0.0}));
+  REQUIRE(out.im == std::vector<double>({1.0, 2.0, 3.0}));
+
+  INFO("long inputs are convolved by FFT and agree with the direct sum");
+  REQUIRE(pack(Expression::makeRange(1.0, 1000.0, 1.0, 1000), a));
+  REQUIRE(pack(Expression::makeRange(0.0, 299.0, 1.0, 300), b));
+  packedConvolve(a, b, out);
+  REQUIRE(out.size() == 1299);
+  for(std::size_t k : {0, 1, 299, 700, 1298}){
+    double expected = 0.0;
+    for(std::size_t j = 0; j <= k; j++){
+      if(j < 1000 && k - j < 300) expected += a.re[j] * b.re[k - j];
+    }
+    REQUIRE(out.re[k] == Approx(expected));
+  }
+
+  REQUIRE(pack(Expression(Expression::List{ Expression(1.0), Expression(2.0), Expression(3.0),
+                                            Expression(4.0), Expression(5.0) }), a));
+  packedMovingAverage(a, 2, out);
+  REQUIRE(out.re == std::vector<double>({1.5, 2.5, 3.5, 4.5}));
+  packedMovingAverage(a, 5, out);
+  REQUIRE(out.re == std::vector<double>({3.0}));
+
+  REQUIRE(pack(Expression::makeRange(0.0, 99999.0, 1.0, 100000), a));
+  packedMovingAverage(a, 7, out);
+  REQUIRE(out.size() == 99994);
+  REQUIRE(out.re[0] == Approx(3.0));
+  REQUIRE(out.re[99993] == Approx(99996.0));
+}